@@ -0,0 +1,510 @@
+/***************************************************************************
+                          bench.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+//!  This program runs the mining engines over a matrix of datasets, support thresholds and options, and checks their results and speed.
+/*!
+  The matrix file has one directive per line (# starts a comment):
+
+  dataset <name> <basket file>                  a dataset, it is skipped if the file does not exist
+  supports <min_supp> ...                       the relative support thresholds
+  engine <name> <program> <argument> ...        an engine and its command line, the arguments may contain
+                                                {input}, {output}, {min_supp}, {min_occurrence} and {options}
+  run <engine> [<option> ...]                   a configuration of an engine, every run is done on every dataset with every threshold
+  reference <file>                              the reference outputs, the file name may contain {dataset} and {min_supp}
+
+  min_occurrence is min_supp multiplied by the number of nonempty baskets and rounded up (the absolute support of fim_all).
+  Every configuration is timed repeat times. The wall clock time and the CPU time of the engine and its peak resident set size
+  are taken from wait4, the median and the minimum of the repeats are reported.
+
+  The frequent itemsets of a configuration (in the text format of apriori or fim_all) are compared as a multiset of
+  itemsets with their supports (the order of the itemsets and of their items does not matter) to the reference output
+  and to the result of the first configuration of the same dataset and threshold (if that one passed).
+
+  The measurements are appended to the history file as JSON lines. A configuration is slower if its minimum time
+  (which is disturbed the least by the other processes) exceeds the median of the minimums of its last (at most history_depth)
+  passing runs by more than tolerance and by more than min_slowdown seconds. The peak memory is checked the same way. The program exits with 1 if a configuration crashes, differs or slows down.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+using namespace std;
+
+/// The number of the previous passing runs whose median is the baseline of a configuration.
+static const unsigned long history_depth = 5;
+
+/// A slowdown below this many seconds is taken as noise.
+static const double min_slowdown = 0.05;
+
+struct Dataset
+{
+   string        name,
+                 path;
+   /// The number of nonempty baskets.
+   unsigned long baskets;
+};
+
+struct Engine
+{
+   string         name;
+   vector<string> command;
+};
+
+struct Run
+{
+   string         engine;
+   vector<string> options;
+};
+
+struct Matrix
+{
+   vector<Dataset> datasets;
+   vector<string>  supports;
+   vector<Engine>  engines;
+   vector<Run>     runs;
+   string          reference;
+};
+
+/// The measurements of an execution of an engine.
+struct Measurement
+{
+   Measurement():wall(0),cpu(0),peak_rss(0) {}
+
+   double        wall,
+                 cpu;
+   unsigned long peak_rss;
+};
+
+/// A line of the history file.
+struct Record
+{
+   string        case_name;
+   double        wall_min;
+   unsigned long peak_rss;
+   bool          passed;
+};
+
+/// Splits the line at the white spaces.
+vector<string> split( const string& line )
+{
+   istringstream  stream( line );
+   vector<string> words;
+   string         word;
+   while( stream >> word ) words.push_back( word );
+   return words;
+}
+
+/// Joins the words with spaces.
+string join( const vector<string>& words )
+{
+   string line;
+   for( vector<string>::const_iterator it_word = words.begin(); it_word != words.end(); it_word++ )
+      line += (it_word == words.begin() ? "" : " ") + *it_word;
+   return line;
+}
+
+/// Replaces every occurrence of pattern in text.
+string replace_all( string text, const string& pattern, const string& value )
+{
+   for( size_t position = text.find( pattern ); position != string::npos; position = text.find( pattern, position + value.size() ) )
+      text.replace( position, pattern.size(), value );
+   return text;
+}
+
+/// Returns the number of lines that contain an item.
+unsigned long count_baskets( const string& path )
+{
+   FILE*         file = fopen( path.c_str(), "r" );
+   unsigned long baskets = 0;
+   bool          has_item = false;
+   int           character;
+   while( (character = getc( file )) != EOF )
+   {
+      if( character == '\n' )
+      {
+         if( has_item ) baskets++;
+         has_item = false;
+      }
+      else if( character >= '0' && character <= '9' ) has_item = true;
+   }
+   if( has_item ) baskets++;
+   fclose( file );
+   return baskets;
+}
+
+/** Reads the matrix file.
+  *
+  * \return false if the file can not be read or it has an invalid line.
+  */
+bool read_matrix( const char* filename, Matrix& matrix )
+{
+   ifstream file( filename );
+   string   line;
+   if( !file ) {cerr << "The matrix file " << filename << " can not be read!" << endl; return false;}
+   for( unsigned long line_number = 1; getline( file, line ); line_number++ )
+   {
+      vector<string> words = split( line.substr( 0, line.find( '#' ) ) );
+      if( words.empty() ) continue;
+      if( words[0] == "dataset" && words.size() == 3 )
+      {
+         Dataset dataset;
+         dataset.name = words[1];
+         dataset.path = words[2];
+         dataset.baskets = 0;
+         matrix.datasets.push_back( dataset );
+      }
+      else if( words[0] == "supports" && words.size() > 1 ) matrix.supports.assign( words.begin()+1, words.end() );
+      else if( words[0] == "engine" && words.size() > 2 )
+      {
+         Engine engine;
+         engine.name = words[1];
+         engine.command.assign( words.begin()+2, words.end() );
+         matrix.engines.push_back( engine );
+      }
+      else if( words[0] == "run" && words.size() > 1 )
+      {
+         Run run;
+         run.engine = words[1];
+         run.options.assign( words.begin()+2, words.end() );
+         matrix.runs.push_back( run );
+      }
+      else if( words[0] == "reference" && words.size() == 2 ) matrix.reference = words[1];
+      else
+      {
+         cerr << filename << ":" << line_number << ": invalid line: " << line << endl;
+         return false;
+      }
+   }
+   for( vector<Run>::const_iterator it_run = matrix.runs.begin(); it_run != matrix.runs.end(); it_run++ )
+   {
+      unsigned long engine_index = 0;
+      while( engine_index < matrix.engines.size() && matrix.engines[engine_index].name != it_run->engine ) engine_index++;
+      if( engine_index == matrix.engines.size() ) {cerr << "Unknown engine: " << it_run->engine << endl; return false;}
+   }
+   return true;
+}
+
+/** Executes the command with its standard output and error redirected to /dev/null.
+  *
+  * \return false if the command can not be started or it does not exit with 0.
+  */
+bool execute( const vector<string>& arguments, Measurement& measurement )
+{
+   vector<char*> argv;
+   for( vector<string>::const_iterator it_argument = arguments.begin(); it_argument != arguments.end(); it_argument++ )
+      argv.push_back( const_cast<char*>( it_argument->c_str() ) );
+   argv.push_back( 0 );
+
+   timespec begin, end;
+   clock_gettime( CLOCK_MONOTONIC, &begin );
+   const pid_t child = fork();
+   if( child < 0 ) return false;
+   if( !child )
+   {
+      const int null_file = open( "/dev/null", O_WRONLY );
+      dup2( null_file, 1 );
+      dup2( null_file, 2 );
+      execv( argv[0], argv.data() );
+      _exit( 127 );
+   }
+   int    status;
+   rusage usage;
+   if( wait4( child, &status, 0, &usage ) != child ) return false;
+   clock_gettime( CLOCK_MONOTONIC, &end );
+   measurement.wall = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) * 1e-9;
+   measurement.cpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+   measurement.peak_rss = (unsigned long) usage.ru_maxrss * 1024;      // ru_maxrss is given in kbytes
+   return WIFEXITED( status ) && !WEXITSTATUS( status );
+}
+
+/** Reads the frequent itemsets of an output file.
+  *
+  * The lines that have no occurrence in parentheses at their end (the headers of apriori) are skipped.
+  * An itemset is given by its items in increasing order and its occurrence, the itemsets are sorted.
+  * \return false if the file can not be read.
+  */
+bool read_itemsets( const string& path, vector<string>& itemsets )
+{
+   ifstream file( path.c_str() );
+   string   line;
+   itemsets.clear();
+   if( !file ) return false;
+   while( getline( file, line ) )
+   {
+      const size_t parenthesis = line.rfind( '(' );
+      if( parenthesis == string::npos || !isdigit( line[parenthesis+1] ) ) continue;
+      vector<unsigned long> items;
+      const char*           position = line.c_str();
+      const char*           end = position + parenthesis;
+      while( position < end )
+      {
+         if( *position >= '0' && *position <= '9' ) items.push_back( strtoul( position, const_cast<char**>( &position ), 10 ) );
+         else position++;
+      }
+      sort( items.begin(), items.end() );
+      ostringstream itemset;
+      for( vector<unsigned long>::const_iterator it_item = items.begin(); it_item != items.end(); it_item++ ) itemset << *it_item << ' ';
+      itemset << '(' << strtoul( line.c_str() + parenthesis + 1, 0, 10 ) << ')';
+      itemsets.push_back( itemset.str() );
+   }
+   sort( itemsets.begin(), itemsets.end() );
+   return true;
+}
+
+/// Returns an empty string if the multisets are the same, otherwise a description of the difference.
+string compare_itemsets( const vector<string>& itemsets, const vector<string>& expected )
+{
+   vector<string> missing, extra;
+   set_difference( expected.begin(), expected.end(), itemsets.begin(), itemsets.end(), back_inserter( missing ) );
+   set_difference( itemsets.begin(), itemsets.end(), expected.begin(), expected.end(), back_inserter( extra ) );
+   if( missing.empty() && extra.empty() ) return "";
+   ostringstream difference;
+   difference << missing.size() << " missing, " << extra.size() << " extra";
+   if( !missing.empty() ) difference << ", first missing: " << missing[0];
+   if( !extra.empty() ) difference << ", first extra: " << extra[0];
+   return difference.str();
+}
+
+/// Returns the value of the field in a JSON line written by append_record (empty if it is missing).
+string json_field( const string& line, const string& name )
+{
+   const string key = "\"" + name + "\": ";
+   size_t       position = line.find( key );
+   if( position == string::npos ) return "";
+   position += key.size();
+   if( line[position] == '"' )
+   {
+      string value;
+      for( position++; position < line.size() && line[position] != '"'; position++ )
+      {
+         if( line[position] == '\\' ) position++;
+         value += line[position];
+      }
+      return value;
+   }
+   return line.substr( position, line.find_first_of( ",}", position ) - position );
+}
+
+/// Returns the string as a JSON string literal.
+string json_string( const string& text )
+{
+   string literal = "\"";
+   for( string::const_iterator it_char = text.begin(); it_char != text.end(); it_char++ )
+   {
+      if( *it_char == '"' || *it_char == '\\' ) literal += '\\';
+      literal += *it_char;
+   }
+   return literal + "\"";
+}
+
+void read_history( const string& filename, vector<Record>& records )
+{
+   ifstream file( filename.c_str() );
+   string   line;
+   while( getline( file, line ) )
+   {
+      Record record;
+      record.case_name = json_field( line, "case" );
+      if( record.case_name.empty() ) continue;
+      record.wall_min = atof( json_field( line, "wall_min" ).c_str() );
+      record.peak_rss = strtoul( json_field( line, "peak_rss_bytes" ).c_str(), 0, 10 );
+      record.passed = json_field( line, "status" ) == "ok";
+      records.push_back( record );
+   }
+}
+
+/// Returns the median of the values (0 if there is none).
+double median( vector<double> values )
+{
+   if( values.empty() ) return 0;
+   sort( values.begin(), values.end() );
+   return values.size() % 2 ? values[values.size()/2] : (values[values.size()/2-1] + values[values.size()/2]) / 2;
+}
+
+/// Returns the short hash of the checked out commit (empty outside of a git repository).
+string git_commit()
+{
+   FILE* pipe = popen( "git rev-parse --short HEAD 2>/dev/null", "r" );
+   char  hash[64] = "";
+   if( !pipe ) return "";
+   if( !fgets( hash, sizeof(hash), pipe ) ) hash[0] = 0;
+   pclose( pipe );
+   return split( hash ).empty() ? "" : split( hash )[0];
+}
+
+void usage()
+{
+   cerr << "\nUsage: bench [options] matrixfile";
+   cerr << "\n\nOptions:";
+   cerr << "\n --repeat <num>\n  -r <num>\t    time every configuration num times. Default: 3";
+   cerr << "\n --tolerance <num>\n  -t <num>\t    a configuration fails if its minimum time or peak memory";
+   cerr << "\n\t\t    exceeds its baseline by more than num fraction. Default: 0.25";
+   cerr << "\n --history <file>\n  -y <file>\t    the JSON lines of the earlier runs. Default: bench/history.jsonl";
+   cerr << "\n --no_record\n  -n\t\t    do not append the measurements to the history.";
+   cerr << "\n --work <dir>\n  -w <dir>\t    the directory of the outputs of the engines. Default: /tmp";
+   cerr << "\n\nThe paths of the matrix file are relative to the working directory.\n\n";
+}
+
+int main( int argc, char* argv[] )
+{
+   unsigned long repeat = 3;
+   double        tolerance = 0.25;
+   string        history_filename = "bench/history.jsonl",
+                 work_directory = "/tmp";
+   bool          record = true;
+   int           arg_index = 1;
+   for( ; arg_index < argc && argv[arg_index][0] == '-'; arg_index++ )
+   {
+      const string option = argv[arg_index];
+      const bool   has_value = arg_index+1 < argc;
+      if( (option == "--repeat" || option == "-r") && has_value ) repeat = strtoul( argv[++arg_index], 0, 10 );
+      else if( (option == "--tolerance" || option == "-t") && has_value ) tolerance = atof( argv[++arg_index] );
+      else if( (option == "--history" || option == "-y") && has_value ) history_filename = argv[++arg_index];
+      else if( (option == "--work" || option == "-w") && has_value ) work_directory = argv[++arg_index];
+      else if( option == "--no_record" || option == "-n" ) record = false;
+      else {usage(); return 1;}
+   }
+   if( arg_index+1 != argc || !repeat ) {usage(); return 1;}
+
+   Matrix matrix;
+   if( !read_matrix( argv[arg_index], matrix ) ) return 1;
+   vector<Record> history;
+   read_history( history_filename, history );
+   ofstream history_file;
+   if( record )
+   {
+      history_file.open( history_filename.c_str(), ios::app );
+      if( !history_file ) {cerr << "The history file " << history_filename << " can not be written!" << endl; return 1;}
+      history_file << fixed << setprecision( 6 );
+   }
+   const string  commit = git_commit();
+   const string  output_path = work_directory + "/bench_" + to_string( getpid() ) + ".txt";
+   unsigned long failures = 0;
+
+   cout << fixed << setprecision( 3 );
+   for( vector<Dataset>::iterator it_dataset = matrix.datasets.begin(); it_dataset != matrix.datasets.end(); it_dataset++ )
+   {
+      if( access( it_dataset->path.c_str(), R_OK ) )
+      {
+         cout << it_dataset->name << ": " << it_dataset->path << " does not exist, skipped." << endl;
+         continue;
+      }
+      it_dataset->baskets = count_baskets( it_dataset->path );
+      cout << it_dataset->name << ": " << it_dataset->baskets << " baskets." << endl;
+      for( vector<string>::const_iterator it_supp = matrix.supports.begin(); it_supp != matrix.supports.end(); it_supp++ )
+      {
+         const unsigned long min_occurrence = (unsigned long) ceil( atof( it_supp->c_str() ) * it_dataset->baskets );
+         const string        reference_path = replace_all( replace_all( matrix.reference, "{dataset}", it_dataset->name ),
+                                                           "{min_supp}", *it_supp );
+         vector<string>      reference,
+                             first_itemsets;
+         bool                has_first = false;    // the first run passed, the others are compared to it
+         const bool          has_reference = !matrix.reference.empty() && read_itemsets( reference_path, reference );
+         for( vector<Run>::const_iterator it_run = matrix.runs.begin(); it_run != matrix.runs.end(); it_run++ )
+         {
+            vector<Engine>::const_iterator it_engine = matrix.engines.begin();
+            while( it_engine->name != it_run->engine ) it_engine++;
+            const Engine& engine = *it_engine;
+            vector<string> arguments;
+            for( vector<string>::const_iterator it_word = engine.command.begin(); it_word != engine.command.end(); it_word++ )
+            {
+               if( *it_word == "{options}" ) arguments.insert( arguments.end(), it_run->options.begin(), it_run->options.end() );
+               else arguments.push_back( replace_all( replace_all( replace_all( replace_all( *it_word, "{input}", it_dataset->path ),
+                                         "{output}", output_path ), "{min_supp}", *it_supp ),
+                                         "{min_occurrence}", to_string( min_occurrence ) ) );
+            }
+            const string case_name = it_dataset->name + " " + *it_supp + " " + engine.name +
+                                     (it_run->options.empty() ? "" : " " + join( it_run->options ));
+            cout << left << setw( 40 ) << case_name << right << flush;
+
+            vector<double> walls, cpus;
+            unsigned long  peak_rss = 0;
+            string         status = "ok",
+                           detail;
+            for( unsigned long repeat_index = 0; repeat_index < repeat && status == "ok"; repeat_index++ )
+            {
+               Measurement measurement;
+               if( !execute( arguments, measurement ) ) {status = "crash"; detail = join( arguments );}
+               walls.push_back( measurement.wall );
+               cpus.push_back( measurement.cpu );
+               peak_rss = max( peak_rss, measurement.peak_rss );
+            }
+            vector<string> itemsets;
+            if( status == "ok" )
+            {
+               read_itemsets( output_path, itemsets );
+               if( has_reference && !(detail = compare_itemsets( itemsets, reference )).empty() )
+               {
+                  status = "differs";
+                  detail = "from " + reference_path + ": " + detail;
+               }
+               else if( has_first && !(detail = compare_itemsets( itemsets, first_itemsets )).empty() )
+               {
+                  status = "differs";
+                  detail = "from " + matrix.runs.begin()->engine + ": " + detail;
+               }
+               if( it_run == matrix.runs.begin() && status == "ok" ) {first_itemsets.swap( itemsets ); has_first = true;}
+            }
+            const double wall_median = median( walls ),
+                         wall_min = *min_element( walls.begin(), walls.end() );
+            if( status == "ok" )
+            {
+               vector<double> baseline_walls, baseline_rss;
+               for( vector<Record>::const_reverse_iterator it_record = history.rbegin();
+                    it_record != history.rend() && baseline_walls.size() < history_depth; it_record++ )
+                  if( it_record->passed && it_record->case_name == case_name )
+                  {
+                     baseline_walls.push_back( it_record->wall_min );
+                     baseline_rss.push_back( it_record->peak_rss );
+                  }
+               const double baseline_wall = median( baseline_walls ),
+                            baseline_peak = median( baseline_rss );
+               ostringstream slowdown;
+               slowdown << fixed << setprecision( 3 );
+               if( !baseline_walls.empty() && wall_min > baseline_wall*(1+tolerance) && wall_min-baseline_wall > min_slowdown )
+                  slowdown << "minimum time " << wall_min << " s, baseline " << baseline_wall << " s";
+               else if( !baseline_rss.empty() && peak_rss > baseline_peak*(1+tolerance) )
+                  slowdown << "peak memory " << peak_rss/1048576.0 << " Mbyte, baseline " << baseline_peak/1048576.0 << " Mbyte";
+               if( !slowdown.str().empty() ) {status = "slower"; detail = slowdown.str();}
+            }
+            cout << "  wall " << setw( 8 ) << wall_median << " s (min " << setw( 8 ) << wall_min << " s)  cpu "
+                 << setw( 8 ) << median( cpus ) << " s  peak " << setw( 9 ) << peak_rss/1048576.0 << " Mbyte  "
+                 << (status == "ok" ? "ok" : "FAILED: " + status) << endl;
+            if( !detail.empty() && status != "ok" ) cout << "    " << detail << endl;
+            if( status != "ok" ) failures++;
+            if( record )
+            {
+               history_file << "{\"case\": " << json_string( case_name ) << ", \"time\": " << time( 0 )
+                            << ", \"commit\": " << json_string( commit ) << ", \"repeat\": " << walls.size()
+                            << ", \"wall_median\": " << wall_median << ", \"wall_min\": " << wall_min
+                            << ", \"cpu_median\": " << median( cpus )
+                            << ", \"peak_rss_bytes\": " << peak_rss << ", \"status\": " << json_string( status ) << "}" << endl;
+            }
+         }
+      }
+   }
+   unlink( output_path.c_str() );
+   if( failures )
+   {
+      cout << endl << failures << " configurations FAILED!" << endl;
+      return 1;
+   }
+   cout << endl << "Every configuration passed." << endl;
+   return 0;
+}
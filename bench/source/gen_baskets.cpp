@@ -0,0 +1,371 @@
+/***************************************************************************
+                          gen_baskets.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+//!  This program generates synthetic basket files for the scaling tests of the benchmark.
+/*!
+  The default mode follows the generator of Agrawal and Srikant (IBM Quest) that produced T10I4D100K.
+  First L potentially frequent itemsets (patterns) are drawn over the items 0 ... N-1. Their size is Poisson distributed
+  with mean I, a fraction of the items of a pattern (exponentially distributed with mean correlation) comes from
+  the previous pattern, the others are random. Every pattern gets an exponentially distributed weight and a corruption level
+  (normally distributed with mean corruption and variance 0.1, clipped to [0, max_corruption]).
+  The size of a transaction is Poisson distributed with mean T. The transaction is filled with patterns chosen by their weights;
+  items are dropped from a pattern while a uniform random number is less than its corruption level. A pattern that does not fit
+  is put into the transaction in half of the cases, otherwise it is kept for the next transaction.
+
+  The clickstream mode (--zipf) imitates kosarak: the length of a session is log-normally distributed with mean T,
+  and its items are drawn from a Zipf distribution over the items with the given exponent (item 0 is the most popular).
+  The repeated items of a session are drawn again, but at most session_draws times the length of the session
+  (the rare items of a steep distribution would take too many draws), so a session may be shorter.
+
+  The baskets are written in the format of data/T10I4D100K.dat (the items of a basket in increasing order, each followed by a space).
+  The same parameters and seed give the same file.
+*/
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+using namespace std;
+
+/// The standard deviation of the logarithm of the session length in the clickstream mode.
+static const double session_sigma = 1.2;
+
+/// A session draws at most this many times its length items; with a steep Zipf curve it may end up shorter.
+static const unsigned long session_draws = 4;
+
+/// The upper bound of the corruption level of a pattern, at 1 every item of the pattern would be dropped.
+static const double max_corruption = 0.99;
+
+/// A xorshift64* generator with the distributions the generator needs.
+class Random
+{
+public:
+   Random( const unsigned long seed ) : state( seed ? seed : 88172645463325252UL ) {for( int warm_up = 0; warm_up < 8; warm_up++ ) next();}
+
+   unsigned long next()
+   {
+      state ^= state >> 12; state ^= state << 25; state ^= state >> 27;
+      return state * 2685821657736338717UL;
+   }
+
+   /// Returns a uniform random number in [0,1).
+   double uniform() {return (next() >> 11) * (1.0/9007199254740992.0);}
+
+   /// Returns a uniform random integer in [0,n).
+   unsigned long below( const unsigned long n ) {return (unsigned long) (uniform() * n);}
+
+   double exponential( const double mean ) {return -mean * log( 1 - uniform() );}
+
+   double normal()
+   {
+      const double radius = sqrt( -2 * log( 1 - uniform() ) );
+      return radius * cos( 2 * M_PI * uniform() );
+   }
+
+   /// Returns a Poisson distributed number (by multiplication of uniform numbers, or by the normal approximation above 30).
+   unsigned long poisson( const double mean )
+   {
+      if( mean > 30 ) return (unsigned long) max( 0.0, floor( mean + sqrt( mean ) * normal() + 0.5 ) );
+      const double  limit = exp( -mean );
+      double        product = uniform();
+      unsigned long number = 0;
+      while( product > limit ) {product *= uniform(); number++;}
+      return number;
+   }
+
+private:
+   unsigned long state;
+};
+
+/** Draws indices with given weights in constant time (the alias method of Walker).
+  *
+  * Index i is drawn with probability weights[i] / (sum of the weights).
+  */
+class Alias_table
+{
+public:
+   Alias_table( const vector<double>& weights ) : probability( weights.size() ), alias( weights.size() )
+   {
+      double sum = 0;
+      for( unsigned long index = 0; index < weights.size(); index++ ) sum += weights[index];
+      vector<unsigned long> small, large;
+      for( unsigned long index = 0; index < weights.size(); index++ )
+      {
+         probability[index] = weights[index] * weights.size() / sum;
+         (probability[index] < 1 ? small : large).push_back( index );
+      }
+      while( !small.empty() && !large.empty() )
+      {
+         const unsigned long less = small.back(),
+                             more = large.back();
+         small.pop_back();
+         alias[less] = more;
+         probability[more] -= 1 - probability[less];
+         if( probability[more] < 1 ) {large.pop_back(); small.push_back( more );}
+      }
+      for( vector<unsigned long>::const_iterator it_index = small.begin(); it_index != small.end(); it_index++ ) probability[*it_index] = 1;
+      for( vector<unsigned long>::const_iterator it_index = large.begin(); it_index != large.end(); it_index++ ) probability[*it_index] = 1;
+   }
+
+   unsigned long draw( Random& random ) const
+   {
+      const unsigned long index = random.below( probability.size() );
+      return random.uniform() < probability[index] ? index : alias[index];
+   }
+
+private:
+   vector<double>        probability;
+   vector<unsigned long> alias;
+};
+
+/// Writes the baskets through a large buffer.
+class Basket_writer
+{
+public:
+   Basket_writer( FILE* file_in ) : file( file_in ), buffer( 1 << 20 ), used( 0 ) {}
+   ~Basket_writer() {flush();}
+
+   /// Writes the items of the basket (they are sorted and unique) and a newline.
+   void write( const vector<unsigned long>& basket )
+   {
+      if( used + 21 * (basket.size()+1) > buffer.size() ) flush();
+      if( 21 * (basket.size()+1) > buffer.size() ) buffer.resize( 21 * (basket.size()+1) );
+      for( vector<unsigned long>::const_iterator it_item = basket.begin(); it_item != basket.end(); it_item++ )
+      {
+         char          digits[20];
+         int           digit_number = 0;
+         unsigned long item = *it_item;
+         do {digits[digit_number++] = '0' + item % 10; item /= 10;} while( item );
+         while( digit_number ) buffer[used++] = digits[--digit_number];
+         buffer[used++] = ' ';
+      }
+      buffer[used++] = '\n';
+   }
+
+   void flush()
+   {
+      if( used && fwrite( buffer.data(), 1, used, file ) != used ) {cerr << "\nThe basket file can not be written!" << endl; exit(1);}
+      used = 0;
+   }
+
+private:
+   FILE*        file;
+   vector<char> buffer;
+   size_t       used;
+};
+
+/// Sorts the basket and removes the repeated items.
+void normalize( vector<unsigned long>& basket )
+{
+   sort( basket.begin(), basket.end() );
+   basket.erase( unique( basket.begin(), basket.end() ), basket.end() );
+}
+
+/// The parameters of the generator.
+struct Parameters
+{
+   unsigned long transactions,
+                 items,
+                 patterns,
+                 seed;
+   double        length,
+                 pattern_length,
+                 correlation,
+                 corruption,
+                 zipf;
+};
+
+void generate_quest( const Parameters& parameters, Basket_writer& writer )
+{
+   Random                          random( parameters.seed );
+   vector< vector<unsigned long> > patterns( parameters.patterns );
+   vector<double>                  weights( parameters.patterns ),
+                                   corruptions( parameters.patterns );
+   for( unsigned long pattern_index = 0; pattern_index < parameters.patterns; pattern_index++ )
+   {
+      vector<unsigned long>& pattern = patterns[pattern_index];
+      const unsigned long    size = min( parameters.items, max( 1UL, random.poisson( parameters.pattern_length ) ) );
+      if( pattern_index )
+      {
+         const vector<unsigned long>& previous = patterns[pattern_index-1];
+         const unsigned long          common = min( (unsigned long) (min( 1.0, random.exponential( parameters.correlation ) ) * size + 0.5 ),
+                                                    previous.size() );
+         for( unsigned long item_index = 0; item_index < common; item_index++ ) pattern.push_back( previous[random.below( previous.size() )] );
+         normalize( pattern );
+      }
+      while( pattern.size() < size )
+      {
+         pattern.push_back( random.below( parameters.items ) );
+         normalize( pattern );
+      }
+      weights[pattern_index] = random.exponential( 1 );
+      corruptions[pattern_index] = min( max_corruption, max( 0.0, parameters.corruption + sqrt( 0.1 ) * random.normal() ) );
+   }
+   const Alias_table     pattern_table( weights );
+   vector<unsigned long> basket,
+                         itemset;
+   bool                  carried = false;      // itemset is a pattern that did not fit into the previous transaction
+   for( unsigned long transaction = 0; transaction < parameters.transactions; transaction++ )
+   {
+      const unsigned long size = max( 1UL, random.poisson( parameters.length ) );
+      basket.clear();
+      while( basket.size() < size )
+      {
+         if( !carried )
+         {
+            const unsigned long pattern_index = pattern_table.draw( random );
+            itemset = patterns[pattern_index];
+            while( itemset.size() && random.uniform() < corruptions[pattern_index] )
+               itemset.erase( itemset.begin() + random.below( itemset.size() ) );
+            if( itemset.empty() ) continue;
+         }
+         carried = false;
+         if( basket.size() + itemset.size() > size && !basket.empty() && random.uniform() < 0.5 )
+         {
+            carried = true;
+            break;
+         }
+         basket.insert( basket.end(), itemset.begin(), itemset.end() );
+         normalize( basket );
+      }
+      writer.write( basket );
+   }
+}
+
+void generate_clickstream( const Parameters& parameters, Basket_writer& writer )
+{
+   Random         random( parameters.seed );
+   vector<double> weights( parameters.items );
+   for( unsigned long item = 0; item < parameters.items; item++ ) weights[item] = pow( item+1.0, -parameters.zipf );
+   const Alias_table     item_table( weights );
+   const double          log_mean = log( parameters.length ) - session_sigma*session_sigma/2;
+   vector<unsigned long> basket;
+   for( unsigned long transaction = 0; transaction < parameters.transactions; transaction++ )
+   {
+      const unsigned long size = min( parameters.items,
+                                      max( 1UL, (unsigned long) floor( exp( log_mean + session_sigma * random.normal() ) + 0.5 ) ) );
+      basket.clear();
+      for( unsigned long draws = 0; basket.size() < size && draws < session_draws*size; )
+      {
+         for( ; basket.size() < size; draws++ ) basket.push_back( item_table.draw( random ) );
+         normalize( basket );
+      }
+      writer.write( basket );
+   }
+}
+
+/// Reads a number with an optional K (thousand) or M (million) suffix from text, returns the position after it.
+const char* read_count( const char* text, double& number )
+{
+   char* end;
+   number = strtod( text, &end );
+   if( *end == 'K' || *end == 'k' ) {number *= 1000; end++;}
+   else if( *end == 'M' || *end == 'm' ) {number *= 1000000; end++;}
+   return end;
+}
+
+/// Sets the parameters from a name like T10I4D100K, returns false if the name is invalid.
+bool read_quest_name( const char* name, Parameters& parameters )
+{
+   double number;
+   while( *name )
+   {
+      const char key = *name;
+      const char* end = read_count( name+1, number );
+      if( end == name+1 || number <= 0 ) return false;
+      if( key == 'T' ) parameters.length = number;
+      else if( key == 'I' ) parameters.pattern_length = number;
+      else if( key == 'D' ) parameters.transactions = (unsigned long) number;
+      else if( key == 'N' ) parameters.items = (unsigned long) number;
+      else if( key == 'L' ) parameters.patterns = (unsigned long) number;
+      else return false;
+      name = end;
+   }
+   return true;
+}
+
+void usage()
+{
+   cerr << "\nUsage: gen_baskets [options] [name]";
+   cerr << "\n\nThe baskets are written to the standard output. The name sets the parameters like T10I4D100K";
+   cerr << "\n(T: average transaction length, I: average pattern length, D: transactions,";
+   cerr << "\nN: items, L: patterns; K and M multiply by a thousand and a million).";
+   cerr << "\n\nOptions:";
+   cerr << "\n --transactions <num>\n  -d <num>\t    number of transactions. Default: 100000";
+   cerr << "\n --length <num>\n  -t <num>\t    average transaction length. Default: 10";
+   cerr << "\n --pattern_length <num>\n  -i <num>\t    average pattern length. Default: 4";
+   cerr << "\n --items <num>\n  -n <num>\t    number of items. Default: 1000";
+   cerr << "\n --patterns <num>\n  -l <num>\t    number of patterns. Default: 2000";
+   cerr << "\n --correlation <num>\n  -c <num>\t    mean fraction of a pattern taken from the previous one. Default: 0.5";
+   cerr << "\n --corruption <num>\n  -r <num>\t    mean corruption level of the patterns, in [0,1).\n\t\t    Default: 0.5";
+   cerr << "\n --zipf <num>\n  -z <num>\t    clickstream mode: the items of the sessions follow a Zipf";
+   cerr << "\n\t\t    distribution with exponent num (kosarak: about 1).";
+   cerr << "\n --seed <num>\n  -s <num>\t    seed of the random generator. Default: 1\n\n";
+}
+
+int main( int argc, char *argv[] )
+{
+   Parameters parameters;
+   parameters.transactions = 100000;
+   parameters.items = 1000;
+   parameters.patterns = 2000;
+   parameters.seed = 1;
+   parameters.length = 10;
+   parameters.pattern_length = 4;
+   parameters.correlation = 0.5;
+   parameters.corruption = 0.5;
+   parameters.zipf = 0;
+   int           optch, cmdindex = 0;
+   char          stropts[] = "hd:t:i:n:l:c:r:z:s:";
+   struct option lopts[] =
+   {
+      {"help",0,0,'h'},
+      {"transactions",1,0,'d'},
+      {"length",1,0,'t'},
+      {"pattern_length",1,0,'i'},
+      {"items",1,0,'n'},
+      {"patterns",1,0,'l'},
+      {"correlation",1,0,'c'},
+      {"corruption",1,0,'r'},
+      {"zipf",1,0,'z'},
+      {"seed",1,0,'s'},
+      {0,0,0,0}
+   };
+   double number;
+   while( (optch = getopt_long( argc, argv, stropts, lopts, &cmdindex )) != EOF )
+      switch( optch )
+      {
+         case 'd' : read_count( optarg, number ); parameters.transactions = (unsigned long) number; break;
+         case 't' : parameters.length = atof( optarg ); break;
+         case 'i' : parameters.pattern_length = atof( optarg ); break;
+         case 'n' : read_count( optarg, number ); parameters.items = (unsigned long) number; break;
+         case 'l' : read_count( optarg, number ); parameters.patterns = (unsigned long) number; break;
+         case 'c' : parameters.correlation = atof( optarg ); break;
+         case 'r' : parameters.corruption = atof( optarg ); break;
+         case 'z' : parameters.zipf = atof( optarg ); break;
+         case 's' : parameters.seed = strtoul( optarg, 0, 10 ); break;
+         default:   usage(); exit(1);
+      }
+   if( argc > optind+1 || (argc == optind+1 && !read_quest_name( argv[optind], parameters )) ) {usage(); exit(1);}
+   if( parameters.length <= 0 || parameters.pattern_length <= 0 || !parameters.items || !parameters.patterns || parameters.zipf < 0 )
+   {
+      cerr << "\nThe lengths and the numbers of items and patterns should be positive, the exponent nonnegative." << endl;
+      exit(1);
+   }
+   if( parameters.corruption < 0 || parameters.corruption >= 1 )
+   {
+      cerr << "\nThe corruption level should be at least 0 and less than 1." << endl;
+      exit(1);
+   }
+
+   Basket_writer writer( stdout );
+   if( parameters.zipf ) generate_clickstream( parameters, writer );
+   else generate_quest( parameters, writer );
+   return 0;
+}
@@ -0,0 +1,123 @@
+/***************************************************************************
+                          main_read_itemsets.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+//!  This program converts the binary output of apriori to the text format.
+/*!
+  apriori --format binary writes the frequent itemsets as records of unsigned LEB128 varints:
+  the size k of the itemset, its smallest item, the k-1 differences of its consecutive items and its occurrence.
+  The file starts with the 8 bytes FIMIBIN1, the records of the same size follow each other in increasing order of the size.
+  The program reads the binary file from the standard input and writes the text format (the items of an itemset in increasing order)
+  to the standard output, so the result can be decoded by decode_items.
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+typedef unsigned long itemtype;
+
+/// The buffered standard input.
+static char   buffer[1048576];
+static size_t buffer_size = 0,
+              buffer_index = 0;
+
+/** Reads a varint from the standard input.
+  *
+  * \param number The number read.
+  * \return false at the end of the input.
+  */
+bool read_varint( unsigned long& number )
+{
+   int shift = 0;
+   number = 0;
+   while( true )
+   {
+      if( buffer_index == buffer_size )
+      {
+         buffer_size = fread( buffer, 1, sizeof(buffer), stdin );
+         buffer_index = 0;
+         if( !buffer_size )
+         {
+            if( shift )
+            {
+               cerr << endl << "The input ends inside a record." << endl;
+               exit(1);
+            }
+            return false;
+         }
+      }
+      const unsigned char byte = buffer[buffer_index++];
+      number |= (unsigned long) (byte & 0x7f) << shift;
+      if( !(byte & 0x80) ) return true;
+      shift += 7;
+   }
+}
+
+/// Reads a varint that has to be present.
+unsigned long read_field()
+{
+   unsigned long number;
+   if( !read_varint( number ) )
+   {
+      cerr << endl << "The input ends inside a record." << endl;
+      exit(1);
+   }
+   return number;
+}
+
+/// Appends an unsigned number in decimal to the line.
+void append_decimal( char*& line_end, unsigned long number )
+{
+   char digits[24];
+   int  digit_index = sizeof(digits);
+   do digits[--digit_index] = '0' + number%10; while( number /= 10 );
+   memcpy( line_end, digits+digit_index, sizeof(digits)-digit_index );
+   line_end += sizeof(digits)-digit_index;
+}
+
+int main()
+{
+   char magic[8];
+   if( fread( magic, 1, sizeof(magic), stdin ) != sizeof(magic) || memcmp( magic, "FIMIBIN1", sizeof(magic) ) )
+   {
+      cerr << endl << "The input is not a binary apriori output." << endl;
+      exit(1);
+   }
+   unsigned long itemset_size,
+                 actual_size = 0,
+                 item,
+                 support;
+   bool          first = true;
+   char          line[32];
+   while( read_varint( itemset_size ) )
+   {
+      if( first || itemset_size != actual_size )
+      {
+         printf( "Frequent %lu-itemsets:\nitemset (occurrence)\n", itemset_size );
+         actual_size = itemset_size;
+         first = false;
+      }
+      if( !itemset_size ) fputs( "{} ", stdout );
+      item = 0;
+      for( unsigned long item_index = 0; item_index < itemset_size; item_index++ )
+      {
+         char* line_end = line;
+         item += read_field();
+         append_decimal( line_end, item );
+         *line_end++ = ' ';
+         fwrite( line, 1, line_end-line, stdout );
+      }
+      support = read_field();
+      char* line_end = line;
+      *line_end++ = '(';
+      append_decimal( line_end, support );
+      *line_end++ = ')';
+      *line_end++ = '\n';
+      fwrite( line, 1, line_end-line, stdout );
+   }
+   return 0;
+}
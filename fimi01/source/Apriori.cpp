@@ -11,146 +11,941 @@
 #include <vector>
 #include <set>
 #include <cmath>   //because of the ceil function
+#include <thread>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 
 using namespace std;
 
-void Apriori::read_in_a_line( FILE* filepoint )
+/// The stored baskets are divided into chunks of this many baskets among the counting threads.
+static const unsigned long chunk_size = 1024;
+
+/// Threads count into private counter arrays if all of them fit into this many bytes, otherwise they share the counters of the trie.
+static const unsigned long private_counter_memory = 256*1048576UL;
+
+/// The commands of the coordinator to the workers (the workers answer count_command with their counters).
+static const unsigned long generate_command = 1,
+                           count_command = 2,
+                           delete_command = 3;
+
+/// Sends size bytes to the socket, stops the program if it is broken.
+static void send_all( const int socket, const void* buffer, size_t size )
 {
-   set<itemtype> tempbasket;
-   char          c;
-   itemtype      pos;
+   const char* position = (const char*) buffer;
+   while( size )
+   {
+      const ssize_t sent = send( socket, position, size, MSG_NOSIGNAL );
+      if( sent <= 0 ) {cerr<<endl<<"The connection between the coordinator and a worker is broken!"<<endl; exit(1);}
+      position += sent;
+      size -= sent;
+   }
+}
 
-   basket.clear();
-   do
+/// Receives size bytes from the socket, returns false if it is closed before the first byte, stops the program if it is broken.
+static bool receive_all( const int socket, void* buffer, size_t size )
+{
+   char* position = (char*) buffer;
+   while( size )
    {
-      int item = 0;
-      pos = 0;
-      c = getc( filepoint );
-      while((c >= '0') && (c <= '9'))
-      {
-         item *= 10;
-         item += int(c)-int('0');
-         c = getc( filepoint );
-         pos++;
-      }
-      if( pos ) tempbasket.insert( (itemtype) item );
-   } while( c != '\n' && !feof(filepoint) );
-   basket.resize( tempbasket.size() );
-   pos = 0;
-   for( set<itemtype>::iterator it = tempbasket.begin(); it != tempbasket.end(); it++, pos++)
-      basket[pos] = *it;
+      const ssize_t received = recv( socket, position, size, 0 );
+      if( received == 0 && position == (char*) buffer ) return false;
+      if( received <= 0 ) {cerr<<endl<<"The connection between the coordinator and a worker is broken!"<<endl; exit(1);}
+      position += received;
+      size -= received;
+   }
+   return true;
+}
+
+/// Sends a message (the command, its argument and the data) to the socket.
+static void send_message( const int socket, const unsigned long command, const unsigned long argument, const vector<unsigned long>& data )
+{
+   const unsigned long header[3] = {command, argument, data.size()};
+   send_all( socket, header, sizeof(header) );
+   if( !data.empty() ) send_all( socket, data.data(), data.size()*sizeof(unsigned long) );
+}
+
+/// Receives a message of send_message from the socket, returns false if the socket is closed.
+static bool receive_message( const int socket, unsigned long& command, unsigned long& argument, vector<unsigned long>& data )
+{
+   unsigned long header[3];
+   if( !receive_all( socket, header, sizeof(header) ) ) return false;
+   command = header[0];
+   argument = header[1];
+   data.resize( header[2] );
+   if( !data.empty() && !receive_all( socket, data.data(), data.size()*sizeof(unsigned long) ) )
+   {
+      cerr<<endl<<"The connection between the coordinator and a worker is broken!"<<endl;
+      exit(1);
+   }
+   return true;
 }
 
-void Apriori::support( FILE* basket_file, const itemtype& candidate_size )
+/** The threshold of the sample is lower than min_supp by this many standard deviations of the relative support of an itemset
+  * whose support is min_supp, so such an itemset is missed from the sample rarely.
+  */
+static const double sample_deviations = 3;
+
+/// The sample is not mined if its occurrence threshold would be less than this, since nearly every subset of its baskets would be frequent.
+static const unsigned long min_sample_occurrence = 5;
+
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::support( const ITEM& candidate_size )
 {
-   if(candidate_size == 1)
+   if( !workers.empty() ) support_workers( candidate_size );
+   else if( store_input )
    {
-      basket_number = 0;
-      while( !feof(basket_file) )
+      if (candidate_size == 2)
       {
-         read_in_a_line( basket_file );
-         if( !basket.empty() )
+         while( input.read_in_a_line( basket ) )
          {
-            basket_number++;
-            trie->find_candidate( basket, candidate_size );
+            scanned_baskets++;
+            trie->basket_recode( basket, recoded_basket );
+            if (recoded_basket.size()>1) reduced_baskets.add(recoded_basket);
+         }
+         reduced_baskets.sort_baskets();
+         vector<unsigned long> sizes(reduced_baskets.size());
+         for (unsigned long basket_index=0;basket_index<reduced_baskets.size();basket_index++)
+         {
+            trie->find_candidate(reduced_baskets.basket_begin(basket_index),reduced_baskets.basket_end(basket_index),
+                                 candidate_size,reduced_baskets.counter(basket_index));
+            if (verified_size) verify_basket(reduced_baskets.basket_begin(basket_index),reduced_baskets.basket_end(basket_index),
+                                             reduced_baskets.counter(basket_index));
+            sizes[basket_index] = reduced_baskets.basket_end(basket_index)-reduced_baskets.basket_begin(basket_index);
+         }
+         prune_baskets(candidate_size, sizes);
+         if (use_basket_tree)
+         {
+            basket_tree.build(reduced_baskets);
+            if (!quiet) cout<<"The basket tree of the "<<reduced_baskets.size()<<" distinct baskets has "<<basket_tree.size()-1<<" nodes ("
+                <<basket_tree.memory()/1024<<" Kbyte)."<<endl;
+            reduced_baskets.clear();
          }
       }
+      else if (use_basket_tree && threads == 1)
+      {
+         scanned_baskets+=basket_tree.size()-1;
+         trie->find_candidate(basket_tree,1,basket_tree.size(),candidate_size);
+      }
+      else
+      {
+         scanned_baskets+=use_basket_tree ? basket_tree.size()-1 : reduced_baskets.size();
+         vector<unsigned long> sizes(reduced_baskets.size());
+         if (threads>1) support_parallel(candidate_size, sizes);
+         else
+         {
+            Counting_context<COUNTER> context = trie->counting_context();
+            atomic<unsigned long>     next_chunk( 0 );
+            support_thread(candidate_size, &context, &next_chunk, &sizes);
+            trie->add_lookups(context);
+         }
+         if (!use_basket_tree) prune_baskets(candidate_size, sizes);
+      }
    }
-   else if( store_input )
+   else while( input.read_in_a_line( basket ) )
    {
-      if (candidate_size == 2)
+      scanned_baskets++;
+      trie->basket_recode(basket, recoded_basket);
+          trie->find_candidate(recoded_basket,candidate_size);
+      if (verified_size) verify_basket(recoded_basket.data(), recoded_basket.data()+recoded_basket.size(), 1);
+   }
+}
+
+/**
+  The workers count their shards at the same time, their counters are added up in the trie.
+  A worker answers with the number of baskets it has counted as the argument of the message.
+  \param candidate_size The size of the candidates
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::support_workers( const ITEM& candidate_size )
+{
+   unsigned long         command,
+                         argument;
+   vector<unsigned long> counters;
+   for( unsigned long worker_index = 0; worker_index < workers.size(); worker_index++ )
+      send_message( workers[worker_index], count_command, candidate_size, counters );
+   for( unsigned long worker_index = 0; worker_index < workers.size(); worker_index++ )
+   {
+      if( !receive_message( workers[worker_index], command, argument, counters ) || command != count_command )
+      {
+         cerr<<endl<<"Worker "<<worker_index+1<<" stopped unexpectedly!"<<endl;
+         exit(1);
+      }
+      scanned_baskets += argument;
+      trie->set_counters( counters, true );
+   }
+}
+
+/**
+  \param frequent_size The size of the frequent itemsets that are extended.
+  \param bundled If true, the candidates are generated from the uncounted candidates (see Trie::candidate_generation).
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::candidate_generation( const ITEM& frequent_size, const bool bundled )
+{
+   for( unsigned long worker_index = 0; worker_index < workers.size(); worker_index++ )
+      send_message( workers[worker_index], generate_command, frequent_size, vector<unsigned long>( 1, bundled ) );
+   trie->candidate_generation( frequent_size, threads, bundled );
+}
+
+/**
+  The workers get the counters of the trie, so they delete the same itemsets even if the threshold is raised by top_k.
+  \param min_occurrence The occurrence threshold.
+  \param border The negative border is collected in it if it is not 0 (see Trie::delete_infrequent).
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::delete_infrequent( const unsigned long min_occurrence, vector<ITEM>* border )
+{
+   if( !workers.empty() )
+   {
+      vector<unsigned long> counters;
+      trie->get_counters( counters );
+      for( unsigned long worker_index = 0; worker_index < workers.size(); worker_index++ )
+         send_message( workers[worker_index], delete_command, min_occurrence, counters );
+   }
+   trie->delete_infrequent( min_occurrence, border );
+}
+
+/**
+  The worker stops when the coordinator closes its socket.
+  \param coordinator The socket of the coordinator.
+  \param item_counters item_counters[i] is the occurrence of item i-1 in the whole database.
+  \param basket_number The number of nonempty baskets of the whole database.
+  \param min_supp_abs The absolute support threshold (it selects the items).
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::work( const int coordinator, const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                                        const unsigned long min_supp_abs )
+{
+   unsigned long         command,
+                         argument;
+   vector<unsigned long> counters;
+   quiet=true;
+   trie->set_first_level(item_counters, basket_number, min_supp_abs);
+   while (receive_message(coordinator, command, argument, counters))
+   {
+      const ITEM size=argument;
+      if (command==generate_command) trie->candidate_generation(size, threads, counters[0]);
+      else if (command==count_command)
+      {
+         input.rewind();
+         scanned_baskets=0;
+         support(size);
+         counters.clear();
+         trie->get_counters(counters);
+         send_message(coordinator, count_command, scanned_baskets, counters);
+      }
+      else
       {
-         while( !feof(basket_file) )
+         trie->set_counters(counters, false);
+         trie->delete_infrequent(argument);
+      }
+   }
+}
+
+/**
+  \param basket_begin The first item of the basket.
+  \param basket_end The end of the basket.
+  \param counter The number the basket occurs in the transactional database.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::verify_basket( const ITEM* basket_begin, const ITEM* basket_end, const COUNTER counter )
+{
+   if (verified_size>2) trie->find_candidate(basket_begin, basket_end, verified_size, counter);
+   if (border_trie && border_size>2) border_trie->find_candidate(basket_begin, basket_end, border_size, counter);
+}
+
+/**
+  The scan is the second scan of the levelwise mining, so the pairs are counted as usual and the stored baskets are replaced
+  by the baskets of the whole database. The larger itemsets are counted in the same scan by verify_basket.
+  The scan is recorded as a phase of metrics.
+  \param border_itemsets A trie of the same items as the trie (0 if there is none).
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::verification_scan( Trie<ITEM,STATE,COUNTER>* border_itemsets )
+{
+   metrics.begin_phase(border_itemsets ? "sample verification" : "partition verification", 0);
+   Metrics::Stopwatch stopwatch;
+   verified_size=trie->prepare_verification(true);
+   border_size=border_itemsets ? border_itemsets->prepare_verification(false) : 0;
+   border_trie=border_itemsets;
+   input.select_lines(0);
+   reduced_baskets.clear();
+   scanned_baskets=0;
+   support(2);
+   stopwatch.stop(metrics.phase().counting);
+   metrics.phase().size=max(verified_size, border_size);
+   metrics.phase().baskets=scanned_baskets;
+   metrics.end_phase(trie->memory()+(border_itemsets ? border_itemsets->memory() : 0));
+   border_trie=0;
+   verified_size=border_size=0;
+}
+
+/**
+  \param border The negative border collected by Trie::delete_infrequent on the sample.
+  \param item_counters item_counters[i] is the occurrence of item i-1.
+  \param basket_number The number of nonempty baskets.
+  \param min_supp_abs The absolute support threshold.
+  \return true, if an itemset of the negative border is frequent. Then the trie contains the frequent itemsets of size at most two,
+          otherwise it contains every frequent itemset.
+*/
+template <class ITEM, class STATE, class COUNTER>
+bool Apriori<ITEM,STATE,COUNTER>::verify_sample( const vector<ITEM>& border, const vector<unsigned long>& item_counters,
+                                                 const unsigned long basket_number, const unsigned long min_supp_abs )
+{
+   Trie<ITEM,STATE,COUNTER> border_itemsets;
+   unsigned long            border_number = 0;
+   for (unsigned long position = 0; position < border.size(); position += (unsigned long) border[position]+1) border_number++;
+   border_itemsets.set_first_level(item_counters, basket_number, min_supp_abs);
+   border_itemsets.add_itemsets(border);
+   cout<<endl<<"Determining the support of the itemsets of the sample, of the "<<border_number
+       <<" larger itemsets of the negative border and of the pairs in one scan of the whole database!"<<endl;
+   verification_scan(&border_itemsets);
+   metrics.phase().candidates=border_number;
+   const unsigned long border_misses=border_itemsets.frequent_leaves(min_supp_abs),
+                       pair_misses=trie->finish_verification(min_supp_abs, border_misses>0);
+   if (border_misses+pair_misses)
+   {
+      cout<<border_misses+pair_misses<<" itemsets of the negative border are frequent ("<<pair_misses
+          <<" of them are pairs), the itemsets of size more than two are mined again!"<<endl;
+      return true;
+   }
+   cout<<"No itemset of the negative border is frequent, the sample contains every frequent itemset."<<endl;
+   return false;
+}
+
+/**
+  \param itemsets The frequent itemsets of the partitions (in the format of Trie::add_itemsets), an itemset may occur several times.
+  \param min_supp_abs The absolute support threshold.
+  \return true, if a frequent pair is not frequent in any partition (it is not possible, unless the thresholds of the partitions are too high).
+          Then the trie contains the frequent itemsets of size at most two, otherwise it contains every frequent itemset.
+*/
+template <class ITEM, class STATE, class COUNTER>
+bool Apriori<ITEM,STATE,COUNTER>::verify_partitions( const vector<ITEM>& itemsets, const unsigned long min_supp_abs )
+{
+   const unsigned long first_level=trie->node_number();
+   trie->add_itemsets(itemsets);
+   const unsigned long itemset_number=trie->node_number()-first_level;
+   cout<<endl<<"Determining the support of the "<<itemset_number
+       <<" itemsets that are frequent in a partition and of the pairs in one scan of the whole database!"<<endl;
+   verification_scan(0);
+   metrics.phase().candidates=itemset_number;
+   const unsigned long pair_misses=trie->finish_verification(min_supp_abs, false);
+   if (pair_misses)
+   {
+      cout<<pair_misses<<" frequent pairs are not frequent in any partition, the itemsets of size more than two are mined again!"<<endl;
+      return true;
+   }
+   return false;
+}
+
+/**
+  Every k-subset of a (k+1)-itemset candidate is a frequent k-itemset, so it was a k-itemset candidate.
+  Thus a basket that contains no candidate of the given size, or has no more items than the candidates,
+  does not contain any larger candidate, and it is removed from the store.
+  (The pairs are not found one by one, so after the second scan only the length of the baskets is checked.)
+  \param candidate_size The size of the candidates counted last
+  \param sizes sizes[i] is the number of the useful items of the i<sup>th</sup> stored basket (0 if it contains no candidate)
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::prune_baskets( const ITEM& candidate_size, vector<unsigned long>& sizes )
+{
+   const unsigned long basket_number = reduced_baskets.size();
+   unsigned long       kept = 0,
+                       item_number = 0,
+                       kept_item_number = 0;
+   for( unsigned long basket_index = 0; basket_index < basket_number; basket_index++ )
+   {
+      item_number += reduced_baskets.basket_end(basket_index) - reduced_baskets.basket_begin(basket_index);
+      if( sizes[basket_index] <= candidate_size ) sizes[basket_index] = 0;
+      else
+      {
+         kept++;
+         kept_item_number += sizes[basket_index];
+      }
+   }
+   if( kept_item_number < item_number ) reduced_baskets.keep_baskets( sizes );
+   if( quiet ) return;
+   cout<<kept<<" of the "<<basket_number<<" stored baskets ("<<(basket_number ? 100.0*kept/basket_number : 0.0)
+       <<"%) can contain larger candidates."<<endl;
+   if( trim_baskets && candidate_size > 2 )
+      cout<<"The trimmed baskets keep "<<kept_item_number<<" of the "<<item_number<<" items ("
+          <<(item_number ? 100.0*kept_item_number/item_number : 0.0)<<"%), "<<reduced_baskets.size()<<" of them are distinct."<<endl;
+}
+
+/**
+  With a basket tree the threads take the subtrees of the root one by one.
+
+  An item of a basket that is contained by less than k found candidate k-itemsets is not contained by any (k+1)-itemset candidate
+  of the basket, since the k-subsets of a candidate are candidates.
+  If trim_baskets is set, the useful items of a basket are moved to its beginning, and the useless ones are removed by prune_baskets.
+  \param candidate_size The size of the candidates
+  \param context The counters of the thread
+  \param next_chunk The index of the first basket (or subtree of the basket tree) that is not taken by any thread
+  \param sizes The thread sets sizes[i] to the number of the useful items if the i<sup>th</sup> stored basket of its chunks contains a candidate
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::support_thread( const ITEM candidate_size, Counting_context<COUNTER>* context,
+                                                  atomic<unsigned long>* next_chunk, vector<unsigned long>* sizes )
+{
+   unsigned long basket_index, chunk_end;
+   if( use_basket_tree )
+   {
+      const vector<unsigned long>& tops = basket_tree.top_nodes();
+      while( (basket_index = next_chunk->fetch_add( 1 )) < tops.size() )
+         trie->find_candidate( basket_tree, tops[basket_index], basket_tree.subtree_end(tops[basket_index]), candidate_size, *context );
+      return;
+   }
+   vector<unsigned long> hits;
+   while( (basket_index = next_chunk->fetch_add( chunk_size )) < reduced_baskets.size() )
+   {
+      chunk_end = min( basket_index+chunk_size, reduced_baskets.size() );
+      for( ; basket_index < chunk_end; basket_index++ )
+      {
+         ITEM*               basket_begin = reduced_baskets.basket_items(basket_index);
+         const unsigned long basket_size = reduced_baskets.basket_end(basket_index) - basket_begin;
+         if( trim_baskets )
+         {
+            hits.assign( basket_size, 0 );
+            context->hits = hits.data();
+         }
+         if( !trie->find_candidate( basket_begin, basket_begin+basket_size, candidate_size, reduced_baskets.counter(basket_index), *context ) )
+            (*sizes)[basket_index] = 0;
+         else if( !trim_baskets ) (*sizes)[basket_index] = basket_size;
+         else
          {
-            read_in_a_line( basket_file );
-            trie->basket_recode( basket );
-            if (basket.size()>1) reduced_baskets[basket]++;
+            unsigned long kept = 0;
+            for( unsigned long item_index = 0; item_index < basket_size; item_index++ )
+               if( hits[basket_size-item_index-1] >= candidate_size ) basket_begin[kept++] = basket_begin[item_index];
+            (*sizes)[basket_index] = kept;
          }
       }
-      for (map<vector<itemtype>,unsigned long, itemsetLess>::iterator it=reduced_baskets.begin();it!=reduced_baskets.end();it++)
-         trie->find_candidate(it->first,candidate_size,it->second);
    }
-   else while (!feof(basket_file))
+   context->hits = 0;
+}
+
+/**
+  Each thread takes chunks of consecutive baskets, so the threads walk similar trie paths as the sorted store does.
+  The counters are summed up before delete_infrequent, so the result does not depend on the number of threads.
+  \param candidate_size The size of the candidates
+  \param sizes sizes[i] becomes the number of the useful items of the i<sup>th</sup> stored basket (0 if it contains no candidate)
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::support_parallel( const ITEM& candidate_size, vector<unsigned long>& sizes )
+{
+   const bool                shared_counters = threads*trie->counter_number()*sizeof(COUNTER) > private_counter_memory;
+   vector< vector<COUNTER> > thread_counters( shared_counters ? 0 : threads );
+   vector< Counting_context<COUNTER> > contexts;
+   vector<thread>            thread_pool;
+   atomic<unsigned long>     next_chunk( 0 );
+
+   for( unsigned thread_index = 0; thread_index < threads; thread_index++ )
+      if( shared_counters ) contexts.push_back( trie->counting_context( true ) );
+      else
+      {
+         thread_counters[thread_index].resize( trie->counter_number(), 0 );
+         contexts.push_back( trie->counting_context( false, thread_counters[thread_index].data() ) );
+      }
+   for( unsigned thread_index = 0; thread_index < threads; thread_index++ )
+      thread_pool.push_back( thread( &Apriori::support_thread, this, candidate_size, &contexts[thread_index], &next_chunk, &sizes ) );
+   for( unsigned thread_index = 0; thread_index < threads; thread_index++ )
    {
-      read_in_a_line(basket_file);
-      trie->basket_recode(basket);
-          trie->find_candidate(basket,candidate_size);
+      thread_pool[thread_index].join();
+      if( !shared_counters ) trie->add_counters( thread_counters[thread_index] );
+      trie->add_lookups( contexts[thread_index] );
    }
 }
-Apriori::Apriori(const bool& store_input, const int& trie_type,const int& child_threshold)
+
+template <class ITEM, class STATE, class COUNTER>
+Apriori<ITEM,STATE,COUNTER>::Apriori(Input_data& input, const bool& store_input, const int& trie_type,const int& child_threshold,
+                                     const unsigned& threads, const Result_writer::format_type format,
+                                     const unsigned long hash_memory, const bool use_basket_tree,
+                                     const bool trim_baskets, const unsigned long bundle_memory, const unsigned long top_k):input(input)
 {
+  this->top_k=top_k;
+  this->bundle_memory=store_input ? 0 : bundle_memory;
+  border_trie=0;
+  verified_size=border_size=0;
+  scanned_baskets=0;
+  quiet=false;
+  this->use_basket_tree=use_basket_tree && store_input;
+  this->trim_baskets=trim_baskets && store_input && !this->use_basket_tree;
   this->store_input=store_input;
-  if (trie_type==1) trie=new Trie();
-  else trie=new Trie_hash(child_threshold);
-  basket_number=0;
+  this->threads=threads ? threads : 1;
+  this->format=format;
+  if (trie_type==1) trie=new Trie<ITEM,STATE,COUNTER>();
+  else trie=new Trie_hash<ITEM,STATE,COUNTER>(child_threshold, hash_memory);
+}
+
+template <class ITEM, class STATE, class COUNTER>
+Apriori<ITEM,STATE,COUNTER>::~Apriori()
+{
+  delete trie;
+}
+
+/**
+  The partition is mined levelwise like the whole database, but it writes nothing.
+  The first level comes from the first scan of the whole database, so the items and their codes are the same as in
+  the trie of the whole database.
+  \param item_counters item_counters[i] is the occurrence of item i-1 in the whole database.
+  \param basket_number The number of nonempty baskets of the whole database.
+  \param min_supp_abs The absolute support threshold of the whole database (it selects the items).
+  \param min_occurrence The occurrence threshold of the itemsets of size more than one in the partition.
+  \param itemsets The vector the frequent itemsets are appended to (in the format of Trie::add_itemsets).
+*/
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Apriori<ITEM,STATE,COUNTER>::mine_partition( const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                                                           const unsigned long min_supp_abs, const unsigned long min_occurrence,
+                                                           vector<ITEM>& itemsets )
+{
+   ITEM candidate_size=1;
+   unsigned long trie_size;
+   quiet=true;
+   trie->set_first_level(item_counters, basket_number, min_supp_abs);
+   trie_size=trie->node_number();
+   trie->candidate_generation(candidate_size, threads);
+   while (trie_size<trie->node_number())
+   {
+      candidate_size++;
+      input.rewind();
+      support(candidate_size);
+      trie->delete_infrequent(min_occurrence);
+      trie_size=trie->node_number();
+      trie->candidate_generation(candidate_size, threads);
+   }
+   return trie->get_itemsets(itemsets);
 }
 
 /**
   \param outcomefile The file the output will be written to.
-  \param basket_filename The name of the datafile that contains the transactions.
-  \param min_supp The relative support threshold
+  \param item_counters item_counters[i] is the occurrence of item i-1 (determined by the first scan).
+  \param basket_number The number of nonempty baskets.
+  \param min_supp_abs The absolute support threshold (in top-k mode it is raised during the mining)
   \param min_conf The confidence threshold for association rules. If min_conf=0 no association rules will be extraced.
+  \param min_lift The lift threshold for association rules (0 if there is none).
+  \param sample_lines If it is not 0, the offsets of the baskets of the sample in the basket file.
+  \param sample_min_occurrence The absolute support threshold of the sample.
+  \param partition_itemsets If it is not 0, the frequent itemsets of the partitions (see mine_partition).
+
+  Every level (its counting, the deletion and the generation of its candidates), the verification scan and the output
+  are recorded as phases of metrics.
 */
-void Apriori::APRIORI_alg(ofstream& outcomefile,const char* basket_filename, const double& min_supp, const double& min_conf)
+template <class ITEM, class STATE, class COUNTER>
+void Apriori<ITEM,STATE,COUNTER>::APRIORI_alg(ofstream& outcomefile, const vector<unsigned long>& item_counters,
+                                              const unsigned long basket_number, const unsigned long min_supp_abs, const double& min_conf,
+                                              const double& min_lift, const vector<size_t>* sample_lines,
+                                              const unsigned long sample_min_occurrence, const vector<ITEM>* partition_itemsets)
 {
-   FILE* basket_file;
-   basket_file=fopen(basket_filename,"r");
-   if (basket_file==NULL) {cerr<<endl<<"File I/O error: basketfile cannot be read!"<<endl;exit(1);}
-
-   cout<<endl<<"\t\tFinding frequent itemsets..."<<endl<<endl;
-   cout<<"Number of frequent 0-itemsets is "<<trie->node_number()<<endl;   //it should be 1 :))
-   itemtype candidate_size=1;
+   ITEM candidate_size=1;
    unsigned long trie_size,trie_size_after_delete=1;
-   cout<<endl<<"Determining the support of the "<<candidate_size<<"-itemset candidates!"<<endl;
-   support(basket_file,candidate_size);
-//   cout<<"\nBasket number"<<basket_number;
-//   trie.statistics();
-//   trie->show_content();
-//   getchar();
-   unsigned long min_supp_abs=(unsigned long) ceil(min_supp*basket_number);
+   unsigned long min_occurrence=min_supp_abs;
+   vector<unsigned long> top_supports;      // the heap of the top_k largest supports of the itemsets of size at least two
+   vector<ITEM> border;                     // the negative border of the frequent itemsets of the sample
+   Metrics::Time generation;                // the generation of the candidates that are counted next
+   Metrics::Stopwatch stopwatch;
+   if (sample_lines)
+   {
+      input.select_lines(sample_lines);
+      min_occurrence=sample_min_occurrence;
+      cout<<"Mining a sample of "<<sample_lines->size()<<" baskets with the occurrence threshold "<<min_occurrence<<"!"<<endl;
+   }
    cout<<"Deleting infrequent items!"<<endl;
-    trie->delete_infrequent(min_supp_abs);
+    trie->set_first_level(item_counters, basket_number, min_supp_abs);
    cout<<"Number of frequent "<<candidate_size<<"-itemsets is "<<trie->node_number()-trie_size_after_delete<<endl;
    trie_size_after_delete=trie->node_number();
+   const unsigned long first_level=trie->node_number();
    trie->statistics();
 //   trie->show_content();
 //   getchar();
    trie_size=trie->node_number();
-   cout<<endl<<"Genarating "<<candidate_size+1<<"-itemset candidates!"<<endl;
-   trie->candidate_generation(candidate_size);
+   const bool mine_levels=!partition_itemsets || verify_partitions(*partition_itemsets, min_supp_abs);
+   if (partition_itemsets) metrics.phase().frequent=trie->node_number()-first_level;
+   if (!mine_levels)
+   {
+      cout<<"Number of frequent itemsets of size more than one is "<<trie->node_number()-trie_size_after_delete<<endl;
+      trie_size=trie_size_after_delete=trie->node_number();
+   }
+   else
+   {
+      if (partition_itemsets)
+      {
+         candidate_size=2;
+         trie_size=trie_size_after_delete=trie->node_number();
+      }
+      cout<<endl<<"Genarating "<<candidate_size+1<<"-itemset candidates!"<<endl;
+      stopwatch.start();
+      candidate_generation(candidate_size);
+      stopwatch.stop(generation);
+   }
    trie->statistics();
 //   trie->show_content();
 //   getchar();
    while (trie_size<trie->node_number())
    {
       candidate_size++;
-      fclose(basket_file);
-       basket_file=fopen(basket_filename,"r");
+      const ITEM counted_size=candidate_size;
+      metrics.begin_phase("level", candidate_size);
+      metrics.phase().candidates=trie->node_number()-trie_size;
+      metrics.phase().generation=generation;
+      generation=Metrics::Time();
+      if (bundle_memory && candidate_size>2 && trie->candidate_bound(candidate_size)*trie->candidate_memory()<=bundle_memory)
+      {
+         trie_size=trie->node_number();
+         cout<<endl<<"Genarating "<<candidate_size+1<<"-itemset candidates from the "<<candidate_size<<"-itemset candidates!"<<endl;
+         stopwatch.start();
+         candidate_generation(candidate_size, true);
+         stopwatch.stop(metrics.phase().generation);
+         metrics.phase().candidates+=trie->node_number()-trie_size;
+         if (trie_size<trie->node_number()) candidate_size++;
+         metrics.phase().size=candidate_size;
+         trie->statistics();
+      }
+      input.rewind();
+      if (counted_size<candidate_size)
+         cout<<"Determining the support of the "<<counted_size<<"- and "<<candidate_size<<"-itemset candidates in one scan!"<<endl;
+      else
          cout<<"Determining the support of the "<<candidate_size<<"-itemset candidates!"<<endl;
-      support(basket_file,candidate_size);
+      scanned_baskets=0;
+      stopwatch.start();
+      support(candidate_size);
+      stopwatch.stop(metrics.phase().counting);
+      metrics.phase().baskets=scanned_baskets;
 //      trie->show_content();
 //      getchar();
+      stopwatch.start();
+      if (top_k)
+      {
+         trie->top_supports(min_occurrence, top_k, top_supports);
+         if (top_supports.size()==top_k && top_supports.front()>min_occurrence)
+         {
+            min_occurrence=top_supports.front();
+            cout<<"The support threshold is raised to "<<min_occurrence<<" (the "<<top_k
+                <<"th largest support of the itemsets of size at least two so far)."<<endl;
+         }
+      }
       cout<<"Deleting infrequent itemsets!"<<endl;
-         trie->delete_infrequent(min_supp_abs);
-      cout<<"Number of frequent "<<candidate_size<<"-itemsets is "<<trie->node_number()-trie_size_after_delete<<endl;
+         delete_infrequent(min_occurrence, sample_lines ? &border : 0);
+      stopwatch.stop(metrics.phase().pruning);
+      metrics.phase().frequent=trie->node_number()-trie_size_after_delete;
+      if (counted_size<candidate_size) cout<<"Number of frequent "<<counted_size<<"- and "<<candidate_size<<"-itemsets is ";
+      else cout<<"Number of frequent "<<candidate_size<<"-itemsets is ";
+      cout<<trie->node_number()-trie_size_after_delete<<endl;
       trie_size_after_delete=trie->node_number();
 //      trie->show_content();
 //      getchar();
       trie_size=trie->node_number();
       trie->statistics();
       cout<<endl<<"Genarating "<<candidate_size+1<<"-itemset candidates!"<<endl;
-      trie->candidate_generation(candidate_size);
+      stopwatch.start();
+      candidate_generation(candidate_size);
+      stopwatch.stop(generation);
+      metrics.end_phase(trie->memory());
       trie->statistics();
 //      trie->show_content();
 //      getchar();
+      if (sample_lines && trie_size==trie->node_number())
+      {
+         sample_lines=0;
+         min_occurrence=min_supp_abs;
+         const bool restart=verify_sample(border, item_counters, basket_number, min_supp_abs);
+         metrics.phase().frequent=trie->node_number()-first_level;
+         trie_size=trie_size_after_delete=trie->node_number();
+         trie->statistics();
+         if (restart)
+         {
+            candidate_size=2;
+            cout<<endl<<"Genarating "<<candidate_size+1<<"-itemset candidates!"<<endl;
+            stopwatch.start();
+            candidate_generation(candidate_size);
+            stopwatch.stop(generation);
+            trie->statistics();
+         }
+      }
+   }
+   metrics.begin_phase("output", 0);
+   stopwatch.start();
+   Result_writer writer(outcomefile, format);
+   trie->write_content_to_file(writer, min_occurrence);
+   writer.finish();
+   for (itemtype itemset_size=1; itemset_size<=writer.max_size(); itemset_size++)
+      metrics.phase().frequent+=writer.itemset_number(itemset_size);
+   if (top_k)
+   {
+      unsigned long itemset_number=0;
+      for (itemtype itemset_size=2; itemset_size<=writer.max_size(); itemset_size++) itemset_number+=writer.itemset_number(itemset_size);
+      cout<<endl<<"The final support threshold is "<<min_occurrence<<", "<<itemset_number
+          <<" itemsets of size at least two are frequent."<<endl;
    }
-   fclose(basket_file);
-   trie->write_content_to_file(outcomefile);
    if (min_conf)
    {
         cout<<"\nGenerating association rules...!\n";
-      trie->association(outcomefile,min_conf);
+      trie->association(outcomefile,min_conf,min_lift,threads,min_occurrence);
+   }
+   stopwatch.stop(metrics.phase().output);
+   metrics.end_phase(trie->memory());
+}
+
+Apriori_driver::Apriori_driver(const bool& store_input, const int& trie_type,const int& child_threshold, const unsigned& threads,
+                               const Result_writer::format_type format, const unsigned long hash_memory,
+                               const bool use_basket_tree, const bool trim_baskets, const unsigned long bundle_memory,
+                               const unsigned long top_k, const double sample_fraction, const unsigned long partition_memory,
+                               const unsigned worker_number)
+{
+  this->worker_number=worker_number;
+  this->partition_memory=partition_memory;
+  this->sample_fraction=sample_fraction;
+  this->top_k=top_k;
+  this->bundle_memory=bundle_memory;
+  this->use_basket_tree=use_basket_tree;
+  this->trim_baskets=trim_baskets;
+  this->store_input=store_input;
+  this->trie_type=trie_type;
+  this->child_threshold=child_threshold;
+  this->threads=threads;
+  this->format=format;
+  this->hash_memory=hash_memory;
+}
+
+template <class ITEM, class STATE, class COUNTER>
+void Apriori_driver::run( ofstream& outcomefile, const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                          const unsigned long min_supp_abs, const double& min_conf, const double& min_lift,
+                          const vector<size_t>* sample_lines, const unsigned long sample_min_occurrence, Metrics* metrics )
+{
+   cout<<"Item codes: "<<8*sizeof(ITEM)<<" bits, states: "<<8*sizeof(STATE)<<" bits, counters: "<<8*sizeof(COUNTER)<<" bits."<<endl;
+   vector<ITEM>  partition_itemsets;
+   vector<int>   workers;
+   vector<pid_t> worker_ids;
+   if (worker_number) start_workers<ITEM,STATE,COUNTER>( item_counters, basket_number, min_supp_abs, workers, worker_ids );
+   else if (!partition_ends.empty())
+   {
+      vector< vector<ITEM> > itemsets(partition_ends.size());
+      vector<unsigned long>  itemset_numbers(partition_ends.size(), 0);
+      vector<thread>         thread_pool;
+      atomic<unsigned long>  next_partition( 0 );
+      Metrics::Stopwatch     stopwatch;
+      const unsigned         partition_threads = min( (unsigned long) threads, (unsigned long) partition_ends.size() );
+      cout<<endl<<"Mining the "<<partition_ends.size()<<" partitions of the basket file with "<<partition_threads<<" threads!"<<endl;
+      for (unsigned thread_index = 0; thread_index < partition_threads; thread_index++)
+         thread_pool.push_back( thread( &Apriori_driver::partition_thread<ITEM,STATE,COUNTER>, this, &item_counters, basket_number,
+                                        min_supp_abs, &next_partition, &itemsets, &itemset_numbers ) );
+      for (unsigned thread_index = 0; thread_index < partition_threads; thread_index++) thread_pool[thread_index].join();
+      if (metrics)
+      {
+         metrics->begin_phase("partitions", 0);
+         stopwatch.stop(metrics->phase().counting);
+         for (unsigned long partition_index = 0; partition_index < partition_ends.size(); partition_index++)
+         {
+            metrics->phase().frequent+=itemset_numbers[partition_index];
+            metrics->phase().baskets+=partition_baskets[partition_index];
+         }
+         metrics->end_phase();
+      }
+      for (unsigned long partition_index = 0; partition_index < partition_ends.size(); partition_index++)
+      {
+         cout<<"Partition "<<partition_index+1<<": "<<partition_baskets[partition_index]<<" baskets, "<<itemset_numbers[partition_index]
+             <<" frequent itemsets of size more than one."<<endl;
+         partition_itemsets.insert( partition_itemsets.end(), itemsets[partition_index].begin(), itemsets[partition_index].end() );
+         vector<ITEM>().swap( itemsets[partition_index] );
+      }
+   }
+   Apriori<ITEM,STATE,COUNTER> apriori( input, store_input && (worker_number || partition_ends.empty()), trie_type, child_threshold,
+                                        threads, format, hash_memory, use_basket_tree, trim_baskets, bundle_memory, top_k );
+   apriori.set_workers( workers );
+   apriori.APRIORI_alg( outcomefile, item_counters, basket_number, min_supp_abs, min_conf, min_lift, sample_lines, sample_min_occurrence,
+                        worker_number || partition_ends.empty() ? 0 : &partition_itemsets );
+   if (metrics) metrics->append( apriori.get_metrics() );
+   for (unsigned long worker_index = 0; worker_index < workers.size(); worker_index++)
+   {
+      close( workers[worker_index] );
+      waitpid( worker_ids[worker_index], 0, 0 );
+   }
+}
+
+/**
+  The workers are forked after the first scan, so they share the mapping of the basket file and the counters of the items.
+  The output of the coordinator is flushed before, and a worker leaves by _exit, so nothing is written twice.
+  \param item_counters item_counters[i] is the occurrence of item i-1 in the whole database.
+  \param basket_number The number of nonempty baskets.
+  \param min_supp_abs The absolute support threshold.
+  \param workers The sockets of the coordinator, one for each worker.
+  \param worker_ids The process ids of the workers.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori_driver::start_workers( const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                                    const unsigned long min_supp_abs, vector<int>& workers, vector<pid_t>& worker_ids )
+{
+   cout<<endl<<"Counting the "<<partition_ends.size()<<" shards of the basket file with "<<partition_ends.size()<<" worker processes!"<<endl;
+   for( unsigned long worker_index = 0; worker_index < partition_ends.size(); worker_index++ )
+   {
+      int sockets[2];
+      if( socketpair( AF_UNIX, SOCK_STREAM, 0, sockets ) ) {cerr<<endl<<"The sockets of the workers can not be created!"<<endl; exit(1);}
+      cout.flush();
+      const pid_t worker_id = fork();
+      if( worker_id < 0 ) {cerr<<endl<<"The worker processes can not be started!"<<endl; exit(1);}
+      if( !worker_id )
+      {
+         for( unsigned long other_index = 0; other_index < workers.size(); other_index++ ) close( workers[other_index] );
+         close( sockets[0] );
+         Input_data shard;
+         shard.open_part( input, worker_index ? partition_ends[worker_index-1] : 0, partition_ends[worker_index] );
+         {
+            Apriori<ITEM,STATE,COUNTER> apriori( shard, store_input, trie_type, child_threshold, threads, format, hash_memory,
+                                                 use_basket_tree, trim_baskets, bundle_memory );
+            apriori.work( sockets[1], item_counters, basket_number, min_supp_abs );
+         }
+         _exit( 0 );
+      }
+      close( sockets[1] );
+      workers.push_back( sockets[0] );
+      worker_ids.push_back( worker_id );
+      cout<<"Worker "<<worker_index+1<<": "<<partition_baskets[worker_index]<<" baskets."<<endl;
    }
-     cout<<"\nMining is done!\n";
 }
 
+/**
+  The threshold of a partition is min_supp_abs scaled to its baskets and rounded down. An itemset that is below it
+  in every partition occurs less than min_supp_abs times in the whole database, so it is not frequent.
+  \param item_counters item_counters[i] is the occurrence of item i-1 in the whole database.
+  \param basket_number The number of nonempty baskets.
+  \param min_supp_abs The absolute support threshold.
+  \param next_partition The index of the first partition that is not taken by any thread.
+  \param itemsets The frequent itemsets of partition i are appended to itemsets[i].
+  \param itemset_numbers itemset_numbers[i] becomes the number of the frequent itemsets of partition i.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Apriori_driver::partition_thread( const vector<unsigned long>* item_counters, const unsigned long basket_number,
+                                       const unsigned long min_supp_abs, atomic<unsigned long>* next_partition,
+                                       vector< vector<ITEM> >* itemsets, vector<unsigned long>* itemset_numbers )
+{
+   unsigned long partition_index;
+   while( (partition_index = next_partition->fetch_add( 1 )) < partition_ends.size() )
+   {
+      if( !partition_baskets[partition_index] ) continue;
+      unsigned long min_occurrence = (unsigned long) floor( (double) min_supp_abs * partition_baskets[partition_index] / basket_number );
+      if( !min_occurrence ) min_occurrence = 1;
+      Input_data partition;
+      partition.open_part( input, partition_index ? partition_ends[partition_index-1] : 0, partition_ends[partition_index] );
+      Apriori<ITEM,STATE,COUNTER> apriori( partition, true, trie_type, child_threshold, 1, format, hash_memory, use_basket_tree,
+                                           trim_baskets );
+      (*itemset_numbers)[partition_index] = apriori.mine_partition( *item_counters, basket_number, min_supp_abs, min_occurrence,
+                                                                    (*itemsets)[partition_index] );
+   }
+}
+
+/**
+  The sample is drawn during the first scan, every nonempty basket is taken with probability sample_fraction.
+  The partitions (or the shards of the workers, which have about the same size) are also determined by the first scan,
+  a partition ends at the first basket that starts partition_memory bytes after its beginning.
+  \param outcomefile The file the output will be written to.
+  \param basket_filename The name of the datafile that contains the transactions.
+  \param min_supp The relative support threshold
+  \param min_conf The confidence threshold for association rules. If min_conf=0 no association rules will be extraced.
+  \param min_lift The lift threshold for association rules (0 if there is none).
+  \param metrics The first scan and the phases of Apriori are appended to it if it is not 0.
+*/
+void Apriori_driver::APRIORI_alg(ofstream& outcomefile,const char* basket_filename, const double& min_supp, const double& min_conf,
+                                 const double& min_lift, Metrics* metrics)
+{
+   if (!input.open(basket_filename)) {cerr<<endl<<"File I/O error: basketfile cannot be read!"<<endl;exit(1);}
+
+   cout<<endl<<"\t\tFinding frequent itemsets..."<<endl<<endl;
+   cout<<"Number of frequent 0-itemsets is 1"<<endl;
+   cout<<endl<<"Determining the support of the 1-itemset candidates!"<<endl;
+   Metrics::Stopwatch    stopwatch;
+   vector<itemtype>      basket;
+   vector<unsigned long> item_counters;
+   unsigned long         basket_number=0;
+   vector<size_t>        sample_lines;
+   unsigned long         random=88172645463325252UL;
+   size_t                line=input.tell(),
+                         partition_begin=line;
+   unsigned long         partition_basket_number=0;
+   const size_t          part_size=worker_number ? (input.size()+worker_number-1)/worker_number : partition_memory;
+   partition_ends.clear();
+   partition_baskets.clear();
+   while( input.read_in_a_line( basket ) )
+   {
+      if( !basket.empty() )
+      {
+         basket_number++;
+         partition_basket_number++;
+         if( sample_fraction )
+         {
+            random ^= random << 13; random ^= random >> 7; random ^= random << 17;
+            if( (random >> 11) * (1.0/9007199254740992.0) < sample_fraction ) sample_lines.push_back( line );
+         }
+         for( vector<itemtype>::const_iterator it_basket = basket.begin(); it_basket != basket.end(); it_basket++ )
+         {
+            if( *it_basket+1 >= item_counters.size() ) item_counters.resize( *it_basket+2, 0 );
+            item_counters[*it_basket+1]++;
+         }
+      }
+      line=input.tell();
+      if( part_size && line-partition_begin >= part_size )
+      {
+         partition_ends.push_back( line );
+         partition_baskets.push_back( partition_basket_number );
+         partition_begin=line;
+         partition_basket_number=0;
+      }
+   }
+   if( part_size && line > partition_begin )
+   {
+      partition_ends.push_back( line );
+      partition_baskets.push_back( partition_basket_number );
+   }
+   if( !worker_number && partition_ends.size() == 1 )
+   {
+      cout<<"The basket file fits into one partition, it is mined in the memory!"<<endl;
+      partition_ends.clear();
+      partition_baskets.clear();
+   }
+   unsigned long min_supp_abs=(unsigned long) ceil(min_supp*basket_number);
+   unsigned long sample_min_occurrence=0;
+   if( !sample_lines.empty() )
+   {
+      double sample_supp=min_supp-sample_deviations*sqrt(min_supp*(1-min_supp)/sample_lines.size());
+      if( sample_supp < min_supp/2 ) sample_supp=min_supp/2;
+      sample_min_occurrence=(unsigned long) ceil(sample_supp*sample_lines.size());
+      if( sample_min_occurrence < min_sample_occurrence )
+      {
+         cout<<"The sample of "<<sample_lines.size()<<" baskets is too small for min_supp, the whole database is mined!"<<endl;
+         sample_lines.clear();
+      }
+   }
+   const vector<size_t>* sample=sample_lines.empty() ? 0 : &sample_lines;
+   unsigned long item_number=0;
+   for( unsigned long item_index = 1; item_index < item_counters.size(); item_index++ )
+      if( item_counters[item_index] >= min_supp_abs ) item_number++;
+   if( metrics )
+   {
+      metrics->begin_phase( "level", 1 );
+      stopwatch.stop( metrics->phase().counting );
+      for( unsigned long item_index = 1; item_index < item_counters.size(); item_index++ )
+         if( item_counters[item_index] ) metrics->phase().candidates++;
+      metrics->phase().frequent = item_number;
+      metrics->phase().baskets = basket_number;
+      metrics->end_phase();
+   }
+
+   // the item codes 1 ... item_number and the width of the bitmap indices of Trie_hash (item_number+1) have to fit into ITEM
+   if( item_number < numeric_limits<unsigned short>::max() )
+   {
+      if( basket_number <= numeric_limits<unsigned int>::max() )
+         run<unsigned short, unsigned int, unsigned int>( outcomefile, item_counters, basket_number, min_supp_abs, min_conf, min_lift, sample,
+                                                          sample_min_occurrence, metrics );
+      else run<unsigned short, unsigned int, unsigned long>( outcomefile, item_counters, basket_number, min_supp_abs, min_conf, min_lift, sample,
+                                                          sample_min_occurrence, metrics );
+   }
+   else
+   {
+      if( basket_number <= numeric_limits<unsigned int>::max() )
+         run<unsigned int, unsigned int, unsigned int>( outcomefile, item_counters, basket_number, min_supp_abs, min_conf, min_lift, sample,
+                                                          sample_min_occurrence, metrics );
+      else run<unsigned int, unsigned int, unsigned long>( outcomefile, item_counters, basket_number, min_supp_abs, min_conf, min_lift, sample,
+                                                          sample_min_occurrence, metrics );
+   }
+   input.close();
+     cout<<"\nMining is done!\n";
+}
@@ -11,33 +11,19 @@
 
 #include "Trie.hpp"
 #include "Trie_hash.hpp"
-#include <map>
+#include "Input_data.hpp"
+#include "Basket_store.hpp"
+#include "Basket_tree.hpp"
+#include "Result_writer.hpp"
+#include "Metrics.hpp"
+#include <atomic>
+#include <sys/types.h>
 
 
 /**
   *@author Bodon Ferenc
   */
 
-/// This struct is responsible for comparing two itemsets
-struct itemsetLess: public binary_function<const vector<itemtype>& , const vector<itemtype>&, bool>
-{
-   bool operator()( const vector<itemtype>& basket_1, const vector<itemtype>& basket_2 ) const
-   {
-      itemtype item_index_1 = 0,
-               item_index_2 = 0;
-      while( item_index_1<basket_1.size() && item_index_2 < basket_2.size() )
-         if( basket_1[item_index_1] < basket_2[item_index_2] ) return true;
-         else if( basket_1[item_index_1] > basket_2[item_index_2] ) return false;
-         else
-         {
-            item_index_1++;
-            item_index_2++;
-         }
-      if( item_index_1 == basket_1.size() && item_index_2 < basket_2.size() ) return true;
-      else return false;
-   }
-};
-
 /** This class implements the APRIORI algirithm.
 
 <p>
@@ -85,27 +71,252 @@ Tries have many advantages over hash-trees.
   <li> The candidate generation is very simple. </li>
 </ol>
 </p>
+
+<p>
+The first scan (counting the items) is done by Apriori_driver, which then instantiates Apriori with
+the narrowest item, state and counter types that fit the frequent items and the number of baskets.
+</p>
+
+<p>
+The reduced baskets (the frequent items of the baskets) are stored after the second scan.
+Optionally they are turned into a prefix tree (Basket_tree), and the candidates are counted on whole subtrees of it,
+so a prefix shared by many baskets is walked only once.
+Otherwise the baskets that contain no candidate are dropped from the store after every scan,
+and optionally the items that are not contained by enough candidates of a basket are trimmed (as in DHP).
+</p>
+
+<p>
+If the baskets are not stored, every level costs a scan of the basket file. Optionally, when the candidates of the next level
+are few enough, they are generated from the candidates that are not counted yet, and the two levels are counted in one scan
+(as in pass bundling). Every frequent itemset is among these candidates, and the other ones are deleted by their exact counts.
+</p>
+
+<p>
+In top-k mode the support threshold is raised during the mining. The supports of the counted candidates of size at least two
+are collected in a heap of the k largest supports, and once it is full, its smallest element is a lower bound of the k<sup>th</sup>
+largest support of all itemsets of size at least two, so the candidates that occur less times are deleted as infrequent
+and they generate no candidates. The result is the same as the result of the mining with the final threshold
+(the k<sup>th</sup> largest support, but at least min_supp): the frequent itemsets of the earlier scans are not deleted,
+they are left out when the itemsets are written.
+</p>
+
+<p>
+In sampling mode (as in the algorithm of Toivonen) the levels are mined on a random sample of the baskets with a lowered threshold
+(the items are counted exactly by the first scan). The infrequent candidates whose every subset is frequent in the sample
+form the negative border, it is stored in a second trie. Then one scan of the whole database counts the itemsets of the sample,
+the negative border and every pair. If no itemset of the negative border is frequent, every frequent itemset is frequent in the sample,
+so the result is exact after two scans. Otherwise the frequent pairs are kept, and the larger itemsets are mined again levelwise.
+</p>
+
+<p>
+In partition mode (as in the algorithm of Savasere, Omiecinski and Navathe) the basket file is split into partitions that fit into the memory.
+Every partition is mined by its own Apriori (in memory, with the threshold scaled to the size of the partition),
+the partitions are processed concurrently. A frequent itemset is frequent in at least one partition,
+so the union of the local results contains every frequent itemset, and one scan of the whole database
+(which does not store the baskets) counts the union and every pair.
+</p>
+
+<p>
+In count distribution mode the basket file is split into shards, and every shard is counted by a worker process
+that keeps a copy of the trie. The Apriori of the coordinator counts nothing: it sends the commands of the levelwise mining
+(candidate generation, support counting, deletion) to the workers through sockets, adds up the counters that they send back,
+and broadcasts the sums together with the threshold before the infrequent itemsets are deleted, so every copy of the trie stays the same.
+</p>
 */
 
-class Apriori {
+template <class ITEM, class STATE, class COUNTER> class Apriori {
 public:
-   Apriori( const bool& store_input, const int& trie_type=1, const int& child_threshold = 5 );
+   Apriori( Input_data& input, const bool& store_input, const int& trie_type=1, const int& child_threshold = 5,
+            const unsigned& threads = 1, const Result_writer::format_type format = Result_writer::TEXT,
+            const unsigned long hash_memory = 0, const bool use_basket_tree = false, const bool trim_baskets = false,
+            const unsigned long bundle_memory = 0, const unsigned long top_k = 0 );
+
+   /** This procedure implements the APRIORI algorithm (from the second scan on).
+     *
+     * The levels are mined on the sample first if it is given. If the itemsets of the partitions are given, they are verified instead.
+     */
+   void APRIORI_alg( ofstream& outcomefile, const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                     const unsigned long min_supp_abs, const double& min_conf, const double& min_lift = 0,
+                     const vector<size_t>* sample_lines = 0, const unsigned long sample_min_occurrence = 0,
+                     const vector<ITEM>* partition_itemsets = 0 );
+
+   /// Sets the sockets of the worker processes, the candidates are counted by them.
+   void set_workers( const vector<int>& workers_in ) {workers = workers_in;}
+
+   /// The main loop of a worker process: executes the commands of the coordinator on the baskets of the input (a shard).
+   void work( const int coordinator, const vector<unsigned long>& item_counters, const unsigned long basket_number,
+              const unsigned long min_supp_abs );
+
+   /// Mines the baskets of the input (a partition) quietly, appends the frequent itemsets of size more than one and returns their number.
+   unsigned long mine_partition( const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                                 const unsigned long min_supp_abs, const unsigned long min_occurrence, vector<ITEM>& itemsets );
+
+   /// Returns the measurements of the phases of APRIORI_alg.
+   const Metrics& get_metrics() const {return metrics;}
 
-   /// This procedure implements the APRIORI algorithm
-   void APRIORI_alg( ofstream& outcomefile, const char* basket_filename, const double& min_supp, const double& min_conf );
+   ~Apriori();
 
 private:
 
-   /// Reads in one transaction from the datafile.
-   void read_in_a_line( FILE* filepoint );
-   /// Determines the support of the candidates of the given size
-   void support( FILE* filepoint, const itemtype& candidate_size );
+   /// Determines the support of the candidates of the given size (>1)
+   void support( const ITEM& candidate_size );
+
+   /// Determines the support of the candidates of the given size by the workers.
+   void support_workers( const ITEM& candidate_size );
+
+   /// Generates the candidates in the trie and in the tries of the workers.
+   void candidate_generation( const ITEM& frequent_size, const bool bundled = false );
+
+   /// Deletes the infrequent itemsets from the trie and from the tries of the workers (the counters are sent to them first).
+   void delete_infrequent( const unsigned long min_occurrence, vector<ITEM>* border = 0 );
+
+   /// Determines the support of the candidates of the given size (>2) on the stored baskets with several threads.
+   void support_parallel( const ITEM& candidate_size, vector<unsigned long>& sizes );
+
+   /// Counts the baskets of the chunks taken from next_chunk until every stored basket (or subtree of the basket tree) is counted.
+   void support_thread( const ITEM candidate_size, Counting_context<COUNTER>* context, atomic<unsigned long>* next_chunk,
+                        vector<unsigned long>* sizes );
+
+   /// Counts the itemsets of the sample and of its negative border in the whole database, returns true if the border is violated.
+   bool verify_sample( const vector<ITEM>& border, const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                       const unsigned long min_supp_abs );
+
+   /// Counts the itemsets of the partitions (added to the trie) and every pair in the whole database, returns true if a frequent pair is missed.
+   bool verify_partitions( const vector<ITEM>& itemsets, const unsigned long min_supp_abs );
+
+   /// Counts every itemset of size more than one of the trie and of the given trie (if it is not 0) in one scan of the whole database.
+   void verification_scan( Trie<ITEM,STATE,COUNTER>* border_itemsets );
+
+   /// Counts the itemsets of the trie and of border_trie of size more than two in the given basket (during verification_scan).
+   void verify_basket( const ITEM* basket_begin, const ITEM* basket_end, const COUNTER counter );
 
-   Trie*                                             trie;
+   /// Removes the stored baskets (and with trim_baskets the items) that can not be contained by any candidate larger than candidate_size.
+   void prune_baskets( const ITEM& candidate_size, vector<unsigned long>& sizes );
+
+   Trie<ITEM,STATE,COUNTER>*                         trie;
+   Input_data&                                       input;
    vector<itemtype>                                  basket;
-   unsigned long                                     basket_number;
-   map<vector<itemtype>, unsigned long, itemsetLess> reduced_baskets;
+   vector<ITEM>                                      recoded_basket;
+   Basket_store<ITEM,COUNTER>                        reduced_baskets;
+   bool                                              store_input;
+
+   /// If true, the stored baskets are turned into basket_tree after the second scan, and the candidates are counted on the tree.
+   bool                                              use_basket_tree;
+   Basket_tree<ITEM,COUNTER>                         basket_tree;
+
+   /// If true, the items of the stored baskets that are not contained by any larger candidate are removed after every scan.
+   bool                                              trim_baskets;
+
+   /** If the baskets are not stored and the candidates of the next level would fit into this many bytes,
+     * they are generated from the uncounted candidates and the two levels are counted in one scan (0: every level has its own scan).
+     */
+   unsigned long                                     bundle_memory;
+
+   /// The negative border of the frequent itemsets of the sample while verification_scan scans the database (0 otherwise).
+   Trie<ITEM,STATE,COUNTER>*                         border_trie;
+
+   /// The size of the largest itemsets of the trie and of border_trie while verification_scan scans the database (0 otherwise).
+   ITEM                                              verified_size,
+                                                     border_size;
+
+   /// If true, the stored baskets are not reported (a partition is mined, or the Apriori is a worker).
+   bool                                              quiet;
+
+   /// The sockets of the worker processes (empty if the candidates are counted by this Apriori).
+   vector<int>                                       workers;
+
+   /// If not 0, the support threshold is raised to the top_k<sup>th</sup> largest support of the itemsets of size at least two.
+   unsigned long                                     top_k;
+
+   /// The number of threads that count the stored baskets, generate the candidates and the association rules.
+   unsigned                                          threads;
+
+   /// The format of the frequent itemsets in the outcome file.
+   Result_writer::format_type                        format;
+
+   /// The number of baskets (distinct stored baskets, or nodes of the basket tree) that support has counted since it was set to 0.
+   unsigned long                                     scanned_baskets;
+
+   /// The measurements of the levels, of the verification scan and of the output.
+   Metrics                                           metrics;
+};
+
+/** Apriori_driver runs the first scan of APRIORI and chooses the instantiation of Apriori.
+
+   The occurrences of the items are counted before the trie exists.
+   Then the item codes are 16-bit if the frequent items fit, the counters are 32-bit if the number of baskets fits,
+   and the states are 32-bit (the trie stops with an error if it outgrows them).
+*/
+class Apriori_driver {
+public:
+   Apriori_driver( const bool& store_input, const int& trie_type=1, const int& child_threshold = 5, const unsigned& threads = 1,
+                   const Result_writer::format_type format = Result_writer::TEXT, const unsigned long hash_memory = 0,
+                   const bool use_basket_tree = false, const bool trim_baskets = false, const unsigned long bundle_memory = 0,
+                   const unsigned long top_k = 0, const double sample_fraction = 0, const unsigned long partition_memory = 0,
+                   const unsigned worker_number = 0 );
+
+   /// This procedure implements the APRIORI algorithm, the phases are recorded in metrics if it is not 0.
+   void APRIORI_alg( ofstream& outcomefile, const char* basket_filename, const double& min_supp, const double& min_conf,
+                     const double& min_lift = 0, Metrics* metrics = 0 );
+
+private:
+
+   /// Runs Apriori<ITEM,STATE,COUNTER> after the first scan.
+   template <class ITEM, class STATE, class COUNTER>
+   void run( ofstream& outcomefile, const vector<unsigned long>& item_counters, const unsigned long basket_number,
+             const unsigned long min_supp_abs, const double& min_conf, const double& min_lift,
+             const vector<size_t>* sample_lines, const unsigned long sample_min_occurrence, Metrics* metrics );
+
+   /// Mines the partitions taken from next_partition, the frequent itemsets of partition i are appended to itemsets[i].
+   template <class ITEM, class STATE, class COUNTER>
+   void partition_thread( const vector<unsigned long>* item_counters, const unsigned long basket_number, const unsigned long min_supp_abs,
+                          atomic<unsigned long>* next_partition, vector< vector<ITEM> >* itemsets,
+                          vector<unsigned long>* itemset_numbers );
+
+   /// Starts a worker process for every part of the basket file, gives the sockets of the coordinator and the process ids.
+   template <class ITEM, class STATE, class COUNTER>
+   void start_workers( const vector<unsigned long>& item_counters, const unsigned long basket_number, const unsigned long min_supp_abs,
+                       vector<int>& workers, vector<pid_t>& worker_ids );
+
+   Input_data                                        input;
    bool                                              store_input;
+   int                                               trie_type;
+   int                                               child_threshold;
+   unsigned                                          threads;
+   Result_writer::format_type                        format;
+
+   /// The memory budget of the bitmap indices of Trie_hash in self tuning mode (0: default).
+   unsigned long                                     hash_memory;
+
+   /// If true, the candidates of size more than two are counted on a prefix tree of the stored baskets.
+   bool                                              use_basket_tree;
+
+   /// If true, the useless items of the stored baskets are removed after every scan.
+   bool                                              trim_baskets;
+
+   /// The memory cap of the candidates of bundled scans (0: no bundling).
+   unsigned long                                     bundle_memory;
+
+   /// The number of the most frequent itemsets of size at least two that are mined (0: every frequent itemset).
+   unsigned long                                     top_k;
+
+   /// If not 0, the levels are mined on a sample that contains a basket with this probability, and they are verified by one scan.
+   double                                            sample_fraction;
+
+   /// If not 0, the basket file is split into partitions of about this many bytes, and they are mined one by one.
+   unsigned long                                     partition_memory;
+
+   /// If not 0, the basket file is split into this many shards, and they are counted by worker processes.
+   unsigned                                          worker_number;
+
+   /** partition_ends[i] is the offset after the last basket of the i<sup>th</sup> partition or shard.
+     *
+     * It is empty if neither partitions nor workers are used, or if there would be only one partition.
+     */
+   vector<size_t>                                    partition_ends;
+
+   /// The number of nonempty baskets of the partitions or shards.
+   vector<unsigned long>                             partition_baskets;
 };
 
 #endif
@@ -0,0 +1,171 @@
+/***************************************************************************
+                          Basket_store.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#include "Basket_store.hpp"
+#include <algorithm>
+
+/// Orders basket indices by the item sequences of the baskets.
+template <class ITEM, class COUNTER> class basket_comp
+{
+public:
+   basket_comp( const Basket_store<ITEM,COUNTER>& store_in ):store(store_in) {}
+   bool operator()( const unsigned long basket_index_1, const unsigned long basket_index_2 ) const
+   {
+      return lexicographical_compare( store.basket_begin(basket_index_1), store.basket_end(basket_index_1),
+                                      store.basket_begin(basket_index_2), store.basket_end(basket_index_2) );
+   }
+private:
+   const Basket_store<ITEM,COUNTER>& store;
+};
+
+template <class ITEM, class COUNTER>
+Basket_store<ITEM,COUNTER>::Basket_store()
+{
+   offsets.push_back(0);
+   hash_table.resize(1024, 0);
+}
+
+template <class ITEM, class COUNTER>
+unsigned long Basket_store<ITEM,COUNTER>::hash_value( const ITEM* basket_begin, const ITEM* basket_end )
+{
+   unsigned long hash = 14695981039346656037UL;
+   for( const ITEM* it_basket = basket_begin; it_basket != basket_end; it_basket++ )
+      hash = (hash ^ *it_basket) * 1099511628211UL;
+   return hash ^ (hash >> 29);
+}
+
+template <class ITEM, class COUNTER>
+void Basket_store<ITEM,COUNTER>::grow_hash_table()
+{
+   vector<unsigned long> new_hash_table( 2*hash_table.size(), 0 );
+   const unsigned long   mask = new_hash_table.size()-1;
+   for( unsigned long basket_index = 0; basket_index < size(); basket_index++ )
+   {
+      unsigned long slot = hashes[basket_index] & mask;
+      while( new_hash_table[slot] ) slot = (slot+1) & mask;
+      new_hash_table[slot] = basket_index+1;
+   }
+   hash_table.swap( new_hash_table );
+}
+
+/**
+  \param basket The recoded basket (items in increasing order).
+  \param counter The number the basket occures in the transactional database.
+*/
+template <class ITEM, class COUNTER>
+void Basket_store<ITEM,COUNTER>::add( const vector<ITEM>& basket, const COUNTER counter )
+{
+   const ITEM*         basket_begin = basket.data();
+   const ITEM*         basket_end = basket_begin+basket.size();
+   const unsigned long hash = hash_value( basket_begin, basket_end ),
+                       mask = hash_table.size()-1;
+   unsigned long       slot = hash & mask;
+
+   while( hash_table[slot] )
+   {
+      const unsigned long basket_index = hash_table[slot]-1;
+      if( hashes[basket_index] == hash && this->basket_end(basket_index)-this->basket_begin(basket_index) == basket_end-basket_begin &&
+          equal( basket_begin, basket_end, this->basket_begin(basket_index) ) )
+      {
+         counters[basket_index] += counter;
+         return;
+      }
+      slot = (slot+1) & mask;
+   }
+   hash_table[slot] = size()+1;
+   items.insert( items.end(), basket_begin, basket_end );
+   offsets.push_back( items.size() );
+   counters.push_back( counter );
+   hashes.push_back( hash );
+   if( 2*size() > hash_table.size() ) grow_hash_table();
+}
+
+template <class ITEM, class COUNTER>
+void Basket_store<ITEM,COUNTER>::sort_baskets()
+{
+   vector<unsigned long>().swap( hash_table );
+   vector<unsigned long>().swap( hashes );
+
+   vector<unsigned long> order( size() );
+   for( unsigned long basket_index = 0; basket_index < size(); basket_index++ ) order[basket_index] = basket_index;
+   sort( order.begin(), order.end(), basket_comp<ITEM,COUNTER>(*this) );
+
+   vector<ITEM>          sorted_items;
+   vector<unsigned long> sorted_offsets;
+   vector<COUNTER>       sorted_counters;
+   sorted_items.reserve( items.size() );
+   sorted_offsets.reserve( offsets.size() );
+   sorted_counters.reserve( counters.size() );
+   sorted_offsets.push_back( 0 );
+   for( vector<unsigned long>::const_iterator it_order = order.begin(); it_order != order.end(); it_order++ )
+   {
+      const unsigned long last_begin = sorted_offsets.size() > 1 ? sorted_offsets[sorted_offsets.size()-2] : 0;
+      if( !sorted_counters.empty() && sorted_items.size()-last_begin == (unsigned long) (basket_end(*it_order)-basket_begin(*it_order)) &&
+          equal( basket_begin(*it_order), basket_end(*it_order), sorted_items.begin()+last_begin ) )
+      {
+         sorted_counters.back() += counters[*it_order];
+         continue;
+      }
+      sorted_items.insert( sorted_items.end(), basket_begin(*it_order), basket_end(*it_order) );
+      sorted_offsets.push_back( sorted_items.size() );
+      sorted_counters.push_back( counters[*it_order] );
+   }
+   items.swap( sorted_items );
+   offsets.swap( sorted_offsets );
+   counters.swap( sorted_counters );
+}
+
+/**
+  If no basket is shortened, the order of the kept baskets does not change, so they stay sorted.
+  Otherwise the baskets are sorted again, and the baskets that became equal are merged.
+  The memory of the removed items is released.
+  \param sizes sizes[i] is the number of the items kept from the beginning of the i<sup>th</sup> basket (0 if it is removed).
+*/
+template <class ITEM, class COUNTER>
+void Basket_store<ITEM,COUNTER>::keep_baskets( const vector<unsigned long>& sizes )
+{
+   unsigned long kept = 0,
+                 item_begin = 0,
+                 item_end = 0;
+   bool          shortened = false;
+   for( unsigned long basket_index = 0; basket_index < size(); basket_index++ )
+   {
+      const unsigned long next_begin = offsets[basket_index+1];   // read before offsets[++kept] overwrites it
+      if( sizes[basket_index] )
+      {
+         if( sizes[basket_index] < next_begin-item_begin ) shortened = true;
+         copy( items.begin()+item_begin, items.begin()+item_begin+sizes[basket_index], items.begin()+item_end );
+         item_end += sizes[basket_index];
+         counters[kept] = counters[basket_index];
+         offsets[++kept] = item_end;
+      }
+      item_begin = next_begin;
+   }
+   items.resize( item_end );
+   offsets.resize( kept+1 );
+   counters.resize( kept );
+   if( shortened ) sort_baskets();
+   else
+   {
+      vector<ITEM>( items ).swap( items );
+      vector<unsigned long>( offsets ).swap( offsets );
+      vector<COUNTER>( counters ).swap( counters );
+   }
+}
+
+template <class ITEM, class COUNTER>
+void Basket_store<ITEM,COUNTER>::clear()
+{
+   vector<ITEM>().swap( items );
+   vector<unsigned long>(1, 0).swap( offsets );
+   vector<COUNTER>().swap( counters );
+   vector<unsigned long>(1024, 0).swap( hash_table );
+   vector<unsigned long>().swap( hashes );
+}
+
+template class Basket_store<unsigned short, unsigned int>;
+template class Basket_store<unsigned short, unsigned long>;
+template class Basket_store<unsigned int, unsigned int>;
+template class Basket_store<unsigned int, unsigned long>;
@@ -0,0 +1,87 @@
+/***************************************************************************
+                          Basket_store.hpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#ifndef BASKET_STORE_H
+#define BASKET_STORE_H
+
+#include "Trie.hpp"
+
+/** Basket_store stores the distinct recoded baskets together with their multiplicity.
+
+   The items of the baskets are packed one after the other into a single array (CSR layout):
+   the items of the i<sup>th</sup> basket are items[offsets[i]] ... items[offsets[i+1]-1].
+   While the baskets are added, duplicates are found by an open addressing hash table,
+   so a basket costs its items and two counters instead of a tree node and a separately allocated vector.
+
+   When every basket has been added, sort_baskets() orders the baskets lexicographically and releases the hash table.
+   Consecutive baskets then share their prefixes, so the support counting walks the same trie paths one after the other.
+   Baskets that can not contain any more candidates are removed by keep_baskets(), which compacts the arrays in place.
+   It also shortens the baskets whose useless items were moved out of their first part (see Apriori::support_thread),
+   then the baskets are sorted again and the baskets that became equal are merged.
+
+   ITEM is the type of the item codes and COUNTER is the type of the multiplicities (the same types as the trie uses).
+*/
+
+template <class ITEM, class COUNTER> class Basket_store
+{
+public:
+
+   Basket_store();
+
+   /// Adds a basket, or increases the counter of the basket if it is already stored.
+   void add( const vector<ITEM>& basket, const COUNTER counter=1 );
+
+   /// Orders the baskets by their item sequence and merges the equal ones. No basket can be added afterwards.
+   void sort_baskets();
+
+   /// Returns the number of distinct baskets.
+   unsigned long size() const {return counters.size();}
+
+   /// Returns the first item of the given basket.
+   const ITEM* basket_begin( const unsigned long basket_index ) const {return items.data()+offsets[basket_index];}
+
+   /// Returns the first item of the given basket for rearranging its items before keep_baskets() is called.
+   ITEM* basket_items( const unsigned long basket_index ) {return items.data()+offsets[basket_index];}
+
+   /// Returns the end of the given basket.
+   const ITEM* basket_end( const unsigned long basket_index ) const {return items.data()+offsets[basket_index+1];}
+
+   /// Returns the number of times the given basket occurs in the transactional database.
+   COUNTER counter( const unsigned long basket_index ) const {return counters[basket_index];}
+
+   /// Keeps the first sizes[i] items of the i<sup>th</sup> basket, the baskets with size 0 are removed.
+   void keep_baskets( const vector<unsigned long>& sizes );
+
+   /// Removes every basket.
+   void clear();
+
+private:
+
+   /// Returns the hash value of an item sequence.
+   static unsigned long hash_value( const ITEM* basket_begin, const ITEM* basket_end );
+
+   /// Doubles the size of the hash table.
+   void grow_hash_table();
+
+   /// items stores the items of the baskets one after the other.
+   vector<ITEM>          items;
+
+   /// offsets[i] is the index of the first item of the i<sup>th</sup> basket in items; offsets[size()] == items.size().
+   vector<unsigned long> offsets;
+
+   /// counters[i] stores the occurrence of the i<sup>th</sup> basket.
+   vector<COUNTER>       counters;
+
+   /** hash_table stores basket indices increased by one; 0 means an empty slot.
+     *
+     * Its size is a power of 2 and it is at most half full.
+     */
+   vector<unsigned long> hash_table;
+
+   /// hashes[i] is the hash value of the i<sup>th</sup> basket, so the hash table can grow without rehashing the items.
+   vector<unsigned long> hashes;
+};
+
+#endif
@@ -0,0 +1,93 @@
+/***************************************************************************
+                          Basket_tree.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#include "Basket_tree.hpp"
+
+template <class ITEM, class COUNTER>
+Basket_tree<ITEM,COUNTER>::Basket_tree()
+{
+   clear();
+}
+
+/**
+  The baskets are inserted in the order of the store. A basket shares the longest prefix with the previous basket
+  that it can share with any basket inserted so far, so the nodes of the previous basket below the common prefix are closed
+  (their subtrees are complete), and the rest of the basket becomes a new path.
+  \param store The baskets, sorted by sort_baskets().
+*/
+template <class ITEM, class COUNTER>
+void Basket_tree<ITEM,COUNTER>::build( const Basket_store<ITEM,COUNTER>& store )
+{
+   vector<unsigned long> path( 1, 0 );     // path[d] is the node of the actual path at depth d
+
+   clear();
+   for( unsigned long basket_index = 0; basket_index < store.size(); basket_index++ )
+   {
+      const ITEM*   basket_begin = store.basket_begin(basket_index);
+      const ITEM*   basket_end = store.basket_end(basket_index);
+      unsigned long common = 0;
+      while( basket_begin+common < basket_end && common+1 < path.size() && items[path[common+1]] == basket_begin[common] ) common++;
+      for( unsigned long depth = path.size()-1; depth > common; depth-- )
+      {
+         ends[path[depth]] = items.size();
+         if( heights[path[depth-1]] < heights[path[depth]]+1 ) heights[path[depth-1]] = heights[path[depth]]+1;
+      }
+      path.resize( common+1 );
+      for( unsigned long depth = 0; depth <= common; depth++ ) weights[path[depth]] += store.counter(basket_index);
+      for( const ITEM* it_basket = basket_begin+common; it_basket != basket_end; it_basket++ )
+      {
+         if( path.size() == 1 ) tops.push_back( items.size() );
+         path.push_back( items.size() );
+         items.push_back( *it_basket );
+         weights.push_back( store.counter(basket_index) );
+         ends.push_back( 0 );
+         heights.push_back( 1 );
+      }
+   }
+   for( unsigned long depth = path.size()-1; depth > 0; depth-- )
+   {
+      ends[path[depth]] = items.size();
+      if( heights[path[depth-1]] < heights[path[depth]]+1 ) heights[path[depth-1]] = heights[path[depth]]+1;
+   }
+   ends[0] = items.size();
+
+   ITEM max_item = 0;
+   for( unsigned long node = 1; node < items.size(); node++ ) if( max_item < items[node] ) max_item = items[node];
+   occurrence_begin.assign( (unsigned long) max_item+2, 0 );
+   for( unsigned long node = 1; node < items.size(); node++ ) occurrence_begin[items[node]+1]++;
+   for( unsigned long item = 1; item < occurrence_begin.size(); item++ ) occurrence_begin[item] += occurrence_begin[item-1];
+   occurrences.resize( items.size()-1 );
+   vector<unsigned long> next( occurrence_begin.begin(), occurrence_begin.end()-1 );
+   for( unsigned long node = 1; node < items.size(); node++ ) occurrences[next[items[node]]++] = node;
+   weight_sums.assign( occurrences.size()+1, 0 );
+   for( unsigned long position = 0; position < occurrences.size(); position++ )
+      weight_sums[position+1] = weight_sums[position] + weights[occurrences[position]];
+}
+
+template <class ITEM, class COUNTER>
+unsigned long Basket_tree<ITEM,COUNTER>::memory() const
+{
+   return items.capacity()*sizeof(ITEM) + weights.capacity()*sizeof(COUNTER) + ends.capacity()*sizeof(unsigned long) +
+          heights.capacity()*sizeof(ITEM) + (tops.capacity() + occurrence_begin.capacity() + occurrences.capacity() +
+          weight_sums.capacity())*sizeof(unsigned long);
+}
+
+template <class ITEM, class COUNTER>
+void Basket_tree<ITEM,COUNTER>::clear()
+{
+   vector<ITEM>(1, 0).swap( items );
+   vector<COUNTER>(1, 0).swap( weights );
+   vector<unsigned long>(1, 1).swap( ends );
+   vector<ITEM>(1, 0).swap( heights );
+   vector<unsigned long>().swap( tops );
+   vector<unsigned long>().swap( occurrence_begin );
+   vector<unsigned long>().swap( occurrences );
+   vector<unsigned long>(1, 0).swap( weight_sums );
+}
+
+template class Basket_tree<unsigned short, unsigned int>;
+template class Basket_tree<unsigned short, unsigned long>;
+template class Basket_tree<unsigned int, unsigned int>;
+template class Basket_tree<unsigned int, unsigned long>;
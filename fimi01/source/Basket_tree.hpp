@@ -0,0 +1,99 @@
+/***************************************************************************
+                          Basket_tree.hpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#ifndef BASKET_TREE_H
+#define BASKET_TREE_H
+
+#include "Basket_store.hpp"
+#include <algorithm>
+
+/** Basket_tree is a prefix tree of the stored baskets.
+
+   Every node represents the common prefix of some baskets: the items on the path from the root to the node.
+   The weight of a node is the number of baskets (in the transactional database) that have this prefix,
+   so a candidate whose last item is found at a node is contained by exactly weight() baskets of the subtree,
+   and Trie::find_candidate counts the candidates against whole subtrees instead of every basket one by one.
+
+   The nodes are stored in depth-first order, so the subtree of node i is the range i ... subtree_end(i)-1, node 0 is the root.
+   height(i) is the number of items on the longest path that starts at node i, so a subtree that is too shallow
+   for the missing items of a candidate can be skipped at once.
+
+   Every item also has the list of its nodes in depth-first order together with the prefix sums of their weights.
+   The nodes of an item within a range of subtrees are a contiguous part of its list (found by binary search),
+   and they are roots of disjoint subtrees, since an item occurs at most once on a path.
+   So a trie node with few edges looks up the nodes of its labels instead of scanning the subtrees,
+   and the occurrences of the candidates of the last level are summed without visiting the nodes at all.
+
+   The tree is built from the sorted Basket_store (sort_baskets() puts the baskets with a common prefix next to each other).
+*/
+
+template <class ITEM, class COUNTER> class Basket_tree
+{
+public:
+
+   Basket_tree();
+
+   /// Builds the tree from the sorted baskets of the store.
+   void build( const Basket_store<ITEM,COUNTER>& store );
+
+   /// Returns the number of nodes (the root included).
+   unsigned long size() const {return items.size();}
+
+   /// Returns the item of the given node (the last item of its prefix).
+   ITEM item( const unsigned long node ) const {return items[node];}
+
+   /// Returns the number of baskets that have the prefix of the given node.
+   COUNTER weight( const unsigned long node ) const {return weights[node];}
+
+   /// Returns the end of the subtree of the given node.
+   unsigned long subtree_end( const unsigned long node ) const {return ends[node];}
+
+   /// Returns the number of items on the longest path that starts at the given node.
+   ITEM height( const unsigned long node ) const {return heights[node];}
+
+   /// Returns the children of the root.
+   const vector<unsigned long>& top_nodes() const {return tops;}
+
+   /// Gives the positions [first,last) of the occurrence list of the nodes of item among the nodes node_begin ... node_end-1.
+   void find_occurrences( const ITEM item, const unsigned long node_begin, const unsigned long node_end,
+                          unsigned long& first, unsigned long& last ) const
+   {
+      if( (unsigned long) item+1 >= occurrence_begin.size() ) {first = last = 0; return;}
+      first = lower_bound( occurrences.begin()+occurrence_begin[item], occurrences.begin()+occurrence_begin[item+1], node_begin )
+              - occurrences.begin();
+      last = lower_bound( occurrences.begin()+first, occurrences.begin()+occurrence_begin[item+1], node_end ) - occurrences.begin();
+   }
+
+   /// Returns the node at the given position of the occurrence lists.
+   unsigned long occurrence( const unsigned long position ) const {return occurrences[position];}
+
+   /// Returns the sum of the weights of the nodes at the positions first ... last-1 of the occurrence lists.
+   unsigned long weight_sum( const unsigned long first, const unsigned long last ) const {return weight_sums[last]-weight_sums[first];}
+
+   /// Returns the number of bytes the tree occupies.
+   unsigned long memory() const;
+
+   /// Removes every node but the root.
+   void clear();
+
+private:
+
+   vector<ITEM>          items;
+   vector<COUNTER>       weights;
+   vector<unsigned long> ends;
+   vector<ITEM>          heights;
+
+   /// The children of the root in increasing order of their items.
+   vector<unsigned long> tops;
+
+   /// The nodes of item i are occurrences[occurrence_begin[i]] ... occurrences[occurrence_begin[i+1]-1] in depth-first order.
+   vector<unsigned long> occurrence_begin;
+   vector<unsigned long> occurrences;
+
+   /// weight_sums[j] is the sum of the weights of the nodes occurrences[0] ... occurrences[j-1].
+   vector<unsigned long> weight_sums;
+};
+
+#endif
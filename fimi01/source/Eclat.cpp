@@ -0,0 +1,348 @@
+/***************************************************************************
+                          Eclat.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#include "Eclat.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cmath>   //because of the ceil function
+#include <climits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+/// Orders the items by their occurrences, ties are broken by the item in decreasing order (as Trie does).
+class item_comp
+{
+public:
+   item_comp( const vector<unsigned long>& counters_in ):counters(counters_in) {}
+   bool operator()( const itemtype edge_1, const itemtype edge_2 ) const
+   {
+      return counters[edge_1] < counters[edge_2] || (counters[edge_1] == counters[edge_2] && edge_1 > edge_2);
+   }
+private:
+   const vector<unsigned long>& counters;
+};
+
+/**
+  \param format The format of the outcome file.
+*/
+Eclat::Eclat( const Result_writer::format_type format )
+{
+   basket_number = 0;
+   min_supp_abs = 0;
+   items_type = TIDLIST;
+   this->format = format;
+   writer = 0;
+}
+
+/**
+  The first scan counts the items, the second one builds the sets of the frequent items.
+  Transactions are identified by their index among the nonempty baskets.
+  \param basket_filename The name of the datafile that contains the transactions.
+  \param min_supp The relative support threshold
+*/
+void Eclat::read_baskets( const char* basket_filename, const double& min_supp )
+{
+   if (!input.open(basket_filename)) {cerr<<endl<<"File I/O error: basketfile cannot be read!"<<endl;exit(1);}
+
+   vector<itemtype>      basket;
+   vector<unsigned long> counters;
+   basket_number = 0;
+   while( input.read_in_a_line( basket ) )
+      if( !basket.empty() )
+      {
+         basket_number++;
+         for( vector<itemtype>::const_iterator it_basket = basket.begin(); it_basket != basket.end(); it_basket++ )
+         {
+            if( *it_basket+1 >= counters.size() ) counters.resize( *it_basket+2, 0 );
+            counters[*it_basket+1]++;
+         }
+      }
+   if( basket_number > UINT_MAX )
+   {
+      cerr<<endl<<"The tids are 32-bit, ECLAT can not mine more than "<<UINT_MAX<<" baskets, use the apriori engine!"<<endl;
+      exit(1);
+   }
+   min_supp_abs = (unsigned long) ceil(min_supp*basket_number);
+   if( min_supp_abs == 0 ) min_supp_abs = 1;
+
+   itemtype edgeIndex;
+   orderarray.assign( 1, 0 );
+   for( edgeIndex = 1; edgeIndex < counters.size(); edgeIndex++ )
+      if( counters[edgeIndex] >= min_supp_abs ) orderarray.push_back( edgeIndex );
+   sort( orderarray.begin()+1, orderarray.end(), item_comp(counters) );
+   vector<itemtype> inv_orderarray( counters.size(), 0 );
+   for( edgeIndex = 1; edgeIndex < orderarray.size(); edgeIndex++ )
+      inv_orderarray[orderarray[edgeIndex]] = edgeIndex;
+
+   const unsigned long item_number = orderarray.size()-1;
+   unsigned long       tid_number = 0;
+   items.resize( item_number );
+   for( edgeIndex = 1; edgeIndex < orderarray.size(); edgeIndex++ )
+   {
+      items[edgeIndex-1].item = edgeIndex;
+      items[edgeIndex-1].support = counters[orderarray[edgeIndex]];
+      tid_number += counters[orderarray[edgeIndex]];
+   }
+   // a tid-list needs 32 bits per occurrence, a bitset needs one bit per basket
+   const unsigned long bitset_words = (basket_number+31)/32;
+   items_type = item_number*bitset_words < tid_number ? BITSET : TIDLIST;
+   for( vector<Class_member>::iterator it_member = items.begin(); it_member != items.end(); it_member++ )
+      if( items_type == BITSET ) it_member->tids.assign( (bitset_words+3)/4*4, 0 );
+      else it_member->tids.reserve( it_member->support );
+
+   vector<unsigned long> supports( item_number+1, 0 );
+   for( edgeIndex = 1; edgeIndex < orderarray.size(); edgeIndex++ )
+      supports[edgeIndex] = items[edgeIndex-1].support;
+   Pair_counter pair_counter;
+   pair_counter.init( item_number, supports, basket_number );
+
+   input.rewind();
+   unsigned tid = 0;
+   while( input.read_in_a_line( basket ) )
+      if( !basket.empty() )
+      {
+         vector<itemtype>::iterator it_recoded = basket.begin();
+         for( vector<itemtype>::const_iterator it_basket = basket.begin(); it_basket != basket.end(); it_basket++ )
+            if( *it_basket+1 < inv_orderarray.size() && inv_orderarray[*it_basket+1] )
+            {
+               vector<unsigned>& tids = items[inv_orderarray[*it_basket+1]-1].tids;
+               if( items_type == BITSET ) tids[tid/32] |= 1U << tid%32;
+               else tids.push_back( tid );
+               *it_recoded++ = inv_orderarray[*it_basket+1];
+            }
+         basket.erase( it_recoded, basket.end() );
+         sort( basket.begin(), basket.end() );
+         if( basket.size() > 1 ) pair_counter.add( basket.data(), basket.data()+basket.size(), 1 );
+         tid++;
+      }
+   input.close();
+
+   vector<itemtype>      first_items,
+                         second_items;
+   vector<unsigned long> pair_counters;
+   pair_counter.frequent_pairs( min_supp_abs, first_items, second_items, pair_counters );
+   pair_counter.clear();
+   partners.assign( item_number+1, vector<itemtype>() );
+   for( unsigned long pair_index = 0; pair_index < first_items.size(); pair_index++ )
+      partners[first_items[pair_index]].push_back( second_items[pair_index] );
+}
+
+/**
+  The 4x4 tids of two blocks are compared by rotating one of the blocks three times.
+  The block with the smaller last tid is consumed; the tids of a block of tids_1 that matched
+  none of the tids of tids_2 belong to the difference.
+  \param tids_1 A sorted tid-list.
+  \param tids_2 A sorted tid-list.
+  \param intersection The tids that are in both lists (if not NULL).
+  \param difference The tids of tids_1 that are not in tids_2 (if not NULL).
+*/
+void Eclat::merge( const vector<unsigned>& tids_1, const vector<unsigned>& tids_2,
+                   vector<unsigned>* intersection, vector<unsigned>* difference )
+{
+   const unsigned *it_1 = tids_1.data(), *end_1 = it_1+tids_1.size(),
+                  *it_2 = tids_2.data(), *end_2 = it_2+tids_2.size();
+   /// bit i is set if it_1[i] has already been found in tids_2
+   int matched = 0;
+#ifdef __SSE2__
+   while( end_1-it_1 >= 4 && end_2-it_2 >= 4 )
+   {
+      const __m128i block_1 = _mm_loadu_si128( (const __m128i*) it_1 ),
+                    block_2 = _mm_loadu_si128( (const __m128i*) it_2 );
+      __m128i equal = _mm_cmpeq_epi32( block_1, block_2 );
+      equal = _mm_or_si128( equal, _mm_cmpeq_epi32( block_1, _mm_shuffle_epi32( block_2, _MM_SHUFFLE(0,3,2,1) ) ) );
+      equal = _mm_or_si128( equal, _mm_cmpeq_epi32( block_1, _mm_shuffle_epi32( block_2, _MM_SHUFFLE(1,0,3,2) ) ) );
+      equal = _mm_or_si128( equal, _mm_cmpeq_epi32( block_1, _mm_shuffle_epi32( block_2, _MM_SHUFFLE(2,1,0,3) ) ) );
+      int mask = _mm_movemask_ps( _mm_castsi128_ps( equal ) );
+      matched |= mask;
+      if( intersection )
+         for( ; mask; mask &= mask-1 ) intersection->push_back( it_1[__builtin_ctz( mask )] );
+
+      const unsigned last_1 = it_1[3], last_2 = it_2[3];
+      if( last_1 <= last_2 )
+      {
+         if( difference )
+            for( int unmatched = ~matched & 15; unmatched; unmatched &= unmatched-1 )
+               difference->push_back( it_1[__builtin_ctz( unmatched )] );
+         it_1 += 4;
+         matched = 0;
+      }
+      if( last_2 <= last_1 ) it_2 += 4;
+   }
+#endif
+   for( ; it_1 != end_1; it_1++, matched >>= 1 )
+   {
+      if( matched & 1 ) continue;
+      while( it_2 != end_2 && *it_2 < *it_1 ) it_2++;
+      if( it_2 == end_2 )
+      {
+         if( !difference ) break;
+         difference->push_back( *it_1 );
+      }
+      else if( *it_2 == *it_1 )
+      {
+         if( intersection ) intersection->push_back( *it_1 );
+         it_2++;
+      }
+      else if( difference ) difference->push_back( *it_1 );
+   }
+}
+
+/**
+  \param bits_1 A bitset.
+  \param bits_2 A bitset of the same size.
+  \param intersection The bitwise and of the two bitsets.
+*/
+unsigned long Eclat::intersect_bitsets( const vector<unsigned>& bits_1, const vector<unsigned>& bits_2,
+                                        vector<unsigned>& intersection )
+{
+   intersection.resize( bits_1.size() );
+   unsigned long support = 0;
+   for( unsigned long word_index = 0; word_index < bits_1.size(); word_index += 4 )
+   {
+#ifdef __SSE2__
+      const __m128i words = _mm_and_si128( _mm_loadu_si128( (const __m128i*) (bits_1.data()+word_index) ),
+                                           _mm_loadu_si128( (const __m128i*) (bits_2.data()+word_index) ) );
+      _mm_storeu_si128( (__m128i*) (intersection.data()+word_index), words );
+#else
+      for( unsigned long index = word_index; index < word_index+4; index++ )
+         intersection[index] = bits_1[index] & bits_2[index];
+#endif
+      support += __builtin_popcount( intersection[word_index] ) + __builtin_popcount( intersection[word_index+1] ) +
+                 __builtin_popcount( intersection[word_index+2] ) + __builtin_popcount( intersection[word_index+3] );
+   }
+   return support;
+}
+
+void Eclat::bitset_to_tidlist( vector<unsigned>& tids )
+{
+   vector<unsigned> tidlist;
+   for( unsigned word_index = 0; word_index < tids.size(); word_index++ )
+      for( unsigned word = tids[word_index]; word; word &= word-1 )
+         tidlist.push_back( word_index*32 + __builtin_ctz( word ) );
+   tids.swap( tidlist );
+}
+
+/**
+  The members are processed in increasing order of their items, and every member is written before its extensions,
+  so the itemsets of the same size are written in lexicographic order.
+  The set of a member is released as soon as its class is processed, since the later members do not need it.
+  The members of the first class (the frequent items) are only extended by their partners.
+  \param members The equivalence class; members[i] represents the actual prefix extended by members[i].item.
+  \param members_type The representation of the sets of the members.
+*/
+void Eclat::mine_class( vector<Class_member>& members, const set_type members_type )
+{
+   vector<Class_member>       children;
+   vector< vector<unsigned> > diffsets;
+   vector<const Class_member*> others;
+   for( vector<Class_member>::iterator it_member = members.begin(); it_member != members.end(); it_member++ )
+   {
+      prefix.push_back( it_member->item );
+      write_itemset( it_member->support );
+
+      children.clear();
+      diffsets.clear();
+      unsigned long tid_number = 0,
+                    diff_number = 0;
+      others.clear();
+      if( prefix.size() == 1 )
+      {
+         for( vector<itemtype>::const_iterator it_partner = partners[it_member->item].begin();
+              it_partner != partners[it_member->item].end(); it_partner++ )
+            others.push_back( &members[*it_partner-1] );
+         vector<itemtype>().swap( partners[it_member->item] );
+      }
+      else for( vector<Class_member>::const_iterator it_other = it_member+1; it_other != members.end(); it_other++ )
+         others.push_back( &*it_other );
+      for( vector<const Class_member*>::const_iterator it_others = others.begin(); it_others != others.end(); it_others++ )
+      {
+         const Class_member* it_other = *it_others;
+         Class_member        child;
+         vector<unsigned>    difference;
+         child.item = it_other->item;
+         if( members_type == BITSET )
+            child.support = intersect_bitsets( it_member->tids, it_other->tids, child.tids );
+         else if( members_type == TIDLIST )
+         {
+            merge( it_member->tids, it_other->tids, &child.tids, &difference );
+            child.support = child.tids.size();
+         }
+         else
+         {
+            merge( it_other->tids, it_member->tids, NULL, &child.tids );
+            child.support = it_member->support - child.tids.size();
+         }
+         if( child.support >= min_supp_abs )
+         {
+            tid_number += child.support;
+            diff_number += difference.size();
+            children.push_back( Class_member() );
+            children.back().item = child.item;
+            children.back().support = child.support;
+            children.back().tids.swap( child.tids );
+            if( members_type == TIDLIST )
+            {
+               diffsets.push_back( vector<unsigned>() );
+               diffsets.back().swap( difference );
+            }
+         }
+      }
+
+      set_type children_type = members_type;
+      if( members_type == BITSET && !children.empty() && tid_number < children.size()*children[0].tids.size() )
+      {
+         children_type = TIDLIST;
+         for( vector<Class_member>::iterator it_child = children.begin(); it_child != children.end(); it_child++ )
+            bitset_to_tidlist( it_child->tids );
+      }
+      else if( members_type == TIDLIST && diff_number < tid_number )
+      {
+         children_type = DIFFSET;
+         for( unsigned long child_index = 0; child_index < children.size(); child_index++ )
+            children[child_index].tids.swap( diffsets[child_index] );
+      }
+      diffsets.clear();
+      vector<unsigned>().swap( it_member->tids );
+      if( !children.empty() ) mine_class( children, children_type );
+      prefix.pop_back();
+   }
+}
+
+/**
+  \param support The support of the actual prefix.
+*/
+void Eclat::write_itemset( const unsigned long support )
+{
+   itemset.resize( prefix.size() );
+   for( itemtype item_index = 0; item_index < prefix.size(); item_index++ )
+      itemset[item_index] = orderarray[prefix[item_index]]-1;
+   writer->write_itemset( itemset.data(), itemset.size(), support );
+}
+
+/**
+  \param outcomefile The file the output will be written to.
+  \param basket_filename The name of the datafile that contains the transactions.
+  \param min_supp The relative support threshold
+*/
+void Eclat::ECLAT_alg( ofstream& outcomefile, const char* basket_filename, const double& min_supp )
+{
+   cout<<endl<<"\t\tFinding frequent itemsets with ECLAT..."<<endl<<endl;
+   cout<<"Building the tidsets of the frequent items!"<<endl;
+   read_baskets( basket_filename, min_supp );
+   cout<<"Number of frequent 1-itemsets is "<<items.size()<<endl;
+   cout<<"The tidsets of the items are stored as "<<(items_type == BITSET ? "bitsets" : "tid-lists")<<'.'<<endl;
+   Result_writer result_writer( outcomefile, format );
+   writer = &result_writer;
+   write_itemset( basket_number );
+   mine_class( items, items_type );
+   for( itemtype item_size = 2; item_size <= result_writer.max_size(); item_size++ )
+      cout<<"Number of frequent "<<item_size<<"-itemsets is "<<result_writer.itemset_number( item_size )<<endl;
+   result_writer.finish();
+   writer = 0;
+   cout<<"\nMining is done!\n";
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+                          Eclat.hpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#ifndef ECLAT_H
+#define ECLAT_H
+
+#include "Input_data.hpp"
+#include "Pair_counter.hpp"
+#include "Result_writer.hpp"
+
+/** This class implements the ECLAT algorithm.
+
+<p>
+ECLAT is a depth-first algorithm that works on the vertical representation of the transactional database.
+After the first scan every frequent item gets the set of the identifiers of the transactions that contain it (its <em>tidset</em>).
+The support of an itemset \f$X\cup\{a,b\}\f$ is the size of the intersection of the tidsets of \f$X\cup\{a\}\f$ and \f$X\cup\{b\}\f$,
+so the database is read only twice.
+The second scan also counts the itempairs by Pair_counter (as Apriori does), so only the tidsets of the frequent pairs are intersected
+and the first class does not even enumerate the infrequent pairs.
+</p>
+
+<p>
+Itemsets with a common prefix form an equivalence class, and the classes are processed recursively.
+Three representations of the sets are used:
+<ol>
+  <li> bitsets (one bit per transaction), if the frequent items are dense. They are intersected 128 bits at a time;</li>
+  <li> sorted tid-lists. They are intersected by an SSE2 block merge that compares 4x4 tids at a time;</li>
+  <li> diffsets: the tids of the prefix that are missing from the itemset, \f$d(Xab)=t(Xa)\setminus t(Xb)\f$ and
+       \f$supp(Xab)=supp(Xa)-|d(Xab)|\f$. A class switches to diffsets when they are smaller than the tid-lists,
+       which happens when the supports are high compared to the support of the prefix.</li>
+</ol>
+A bitset class switches to tid-lists when the sets become sparse.
+The tids are 32-bit (the block merge compares four of them in a register), so at most UINT_MAX baskets can be mined.
+</p>
+
+<p>
+Items are coded in the same frequency order as in Trie, and the itemsets are written by Result_writer in the same order
+as Trie::write_content_to_file, so the results of the two engines can be compared by diff.
+</p>
+*/
+
+class Eclat
+{
+public:
+
+   Eclat( const Result_writer::format_type format = Result_writer::TEXT );
+
+   /// This procedure implements the ECLAT algorithm
+   void ECLAT_alg( ofstream& outcomefile, const char* basket_filename, const double& min_supp );
+
+private:
+
+   /// The representations of the sets of an equivalence class.
+   enum set_type {BITSET, TIDLIST, DIFFSET};
+
+   /// A member of an equivalence class: the last item of the itemset, its support and its set.
+   struct Class_member
+   {
+      itemtype         item;
+      unsigned long    support;
+      vector<unsigned> tids;
+   };
+
+   /// Determines the frequent items and builds their sets.
+   void read_baskets( const char* basket_filename, const double& min_supp );
+
+   /// Processes an equivalence class (the members extend the actual prefix by one item).
+   void mine_class( vector<Class_member>& members, const set_type members_type );
+
+   /// Gives the itemset prefix to the writer.
+   void write_itemset( const unsigned long support );
+
+   /// Computes the intersection and the difference of two sorted tid-lists.
+   static void merge( const vector<unsigned>& tids_1, const vector<unsigned>& tids_2,
+                      vector<unsigned>* intersection, vector<unsigned>* difference );
+
+   /// Computes the intersection of two bitsets and returns the number of its bits.
+   static unsigned long intersect_bitsets( const vector<unsigned>& bits_1, const vector<unsigned>& bits_2,
+                                           vector<unsigned>& intersection );
+
+   /// Converts a bitset to a sorted tid-list.
+   static void bitset_to_tidlist( vector<unsigned>& tids );
+
+   Input_data           input;
+   unsigned long        basket_number;
+   unsigned long        min_supp_abs;
+
+   /** The frequency order of the items
+     *
+     * orderarray[1] is the least frequent item, the codes are the same as in Trie.
+     */
+   vector<itemtype>     orderarray;
+
+   /// The items of the actual itemset (codes).
+   vector<itemtype>     prefix;
+
+   /// The members of the first equivalence class (the frequent items).
+   vector<Class_member> items;
+
+   /// items_type is the representation of the sets of the frequent items.
+   set_type             items_type;
+
+   /// partners[i] lists the items j>i for which {i,j} is frequent, in increasing order.
+   vector< vector<itemtype> > partners;
+
+   /// The format of the outcome file.
+   Result_writer::format_type format;
+
+   /// The writer of the outcome file while ECLAT_alg runs.
+   Result_writer*       writer;
+
+   /// The items of the actual itemset (the original items).
+   vector<itemtype>     itemset;
+};
+
+#endif
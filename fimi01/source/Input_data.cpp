@@ -0,0 +1,189 @@
+/***************************************************************************
+                          Input_data.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#include "Input_data.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+Input_data::Input_data()
+{
+   data = NULL;
+   data_size = 0;
+   position = NULL;
+   mapped = false;
+   lines = NULL;
+   line_index = 0;
+}
+
+/**
+  \param basket_filename The name of the datafile that contains the transactions.
+  \return false, if the file cannot be read.
+*/
+bool Input_data::open( const char* basket_filename )
+{
+   close();
+   int file_descriptor = ::open( basket_filename, O_RDONLY );
+   if( file_descriptor < 0 ) return false;
+
+   struct stat file_status;
+   if( fstat( file_descriptor, &file_status ) == 0 && S_ISREG(file_status.st_mode) && file_status.st_size > 0 )
+   {
+      void* mapping = mmap( NULL, file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0 );
+      if( mapping != MAP_FAILED )
+      {
+         madvise( mapping, file_status.st_size, MADV_SEQUENTIAL );
+         data = (const char*) mapping;
+         data_size = file_status.st_size;
+         mapped = true;
+      }
+   }
+   if( !mapped )
+   {
+      char    block[65536];
+      ssize_t read_size;
+      while( (read_size = read( file_descriptor, block, sizeof(block) )) > 0 )
+         buffer.insert( buffer.end(), block, block+read_size );
+      if( read_size < 0 ) { ::close( file_descriptor ); return false; }
+      data = buffer.empty() ? NULL : &buffer[0];
+      data_size = buffer.size();
+   }
+   ::close( file_descriptor );
+   position = data;
+   return true;
+}
+
+/**
+  The part shares the mapping (or the buffer) of source, it does not release it.
+  \param source An opened basket file.
+  \param begin The offset of the first basket of the part (see tell()).
+  \param end The offset after the last basket of the part.
+*/
+void Input_data::open_part( const Input_data& source, const size_t begin, const size_t end )
+{
+   close();
+   data = source.data+begin;
+   data_size = end-begin;
+   position = data;
+}
+
+/**
+  \param line_begin The first character of the line.
+  \param line_end The character after the last character of the line.
+  \param basket The items are appended to this vector.
+*/
+void Input_data::tokenize( const char* line_begin, const char* line_end, vector<itemtype>& basket )
+{
+   const char* it_char = line_begin;
+   itemtype    item = 0;
+   bool        in_item = false;
+
+#ifdef __SSE2__
+   const __m128i below_digits = _mm_set1_epi8( '0'-1 ),
+                 above_digits = _mm_set1_epi8( '9'+1 );
+   for( ; it_char+16 <= line_end; it_char += 16 )
+   {
+      __m128i  block = _mm_loadu_si128( (const __m128i*) it_char );
+      unsigned digit_mask = _mm_movemask_epi8( _mm_and_si128( _mm_cmpgt_epi8( block, below_digits ),
+                                                              _mm_cmplt_epi8( block, above_digits ) ) );
+      unsigned char_index = 0;
+      while( char_index < 16 )
+      {
+         if( !in_item )
+         {
+            if( !(digit_mask >> char_index) ) break;
+            char_index += __builtin_ctz( digit_mask >> char_index );
+            in_item = true;
+            item = 0;
+         }
+         // ~(digit_mask >> char_index) has a bit set at 16-char_index, so the run cannot leave the block.
+         unsigned run_end = char_index + __builtin_ctz( ~(digit_mask >> char_index) );
+         for( ; char_index < run_end; char_index++ )
+            item = item*10 + (it_char[char_index]-'0');
+         if( char_index < 16 )
+         {
+            basket.push_back( item );
+            in_item = false;
+         }
+      }
+   }
+#endif
+   for( ; it_char < line_end; it_char++ )
+   {
+      if( *it_char >= '0' && *it_char <= '9' )
+      {
+         if( !in_item ) { item = 0; in_item = true; }
+         item = item*10 + (*it_char-'0');
+      }
+      else if( in_item )
+      {
+         basket.push_back( item );
+         in_item = false;
+      }
+   }
+   if( in_item ) basket.push_back( item );
+}
+
+/**
+  \param basket The items of the next transaction in increasing order without duplicates. The vector is cleared first.
+  \return false, if there are no more transactions in the file.
+*/
+bool Input_data::read_in_a_line( vector<itemtype>& basket )
+{
+   basket.clear();
+   if( lines )
+   {
+      if( line_index == lines->size() ) return false;
+      position = data+(*lines)[line_index++];
+   }
+   if( position == data+data_size ) return false;
+
+   const char* line_end = (const char*) memchr( position, '\n', data+data_size-position );
+   if( line_end == NULL ) line_end = data+data_size;
+   tokenize( position, line_end, basket );
+   position = line_end == data+data_size ? line_end : line_end+1;
+
+   sort( basket.begin(), basket.end() );
+   basket.erase( unique( basket.begin(), basket.end() ), basket.end() );
+   return true;
+}
+
+void Input_data::rewind()
+{
+   position = data;
+   line_index = 0;
+}
+
+/**
+  \param lines_in The offsets of the first characters of the baskets (see tell()), they have to be increasing.
+*/
+void Input_data::select_lines( const vector<size_t>* lines_in )
+{
+   lines = lines_in;
+   rewind();
+}
+
+void Input_data::close()
+{
+   if( mapped ) munmap( (void*) data, data_size );
+   vector<char>().swap( buffer );
+   data = NULL;
+   data_size = 0;
+   position = NULL;
+   mapped = false;
+   lines = NULL;
+   line_index = 0;
+}
+
+Input_data::~Input_data()
+{
+   close();
+}
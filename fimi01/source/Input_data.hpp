@@ -0,0 +1,83 @@
+/***************************************************************************
+                          Input_data.hpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#ifndef INPUT_DATA_H
+#define INPUT_DATA_H
+
+#include "Trie.hpp"
+#include <cstddef>
+
+/** Input_data reads the baskets of the transactional database.
+
+   The whole basket file is mapped into the memory, so reading a basket needs neither a system call nor a copy.
+   Lines are found by memchr and the items of a line are tokenized by a SIMD digit scanner that classifies 16 characters at a time.
+   The items of the basket are sorted and the duplicates are removed in the vector given by the caller,
+   so if the same vector is used for every basket, no memory is allocated once it has grown to the longest basket.
+
+   If the file cannot be mapped (pipes, special files) it is read into a buffer instead.
+   The reading can be restricted to some of the baskets (a sample) given by their offsets in the file.
+   A part of an opened file (a partition) can be read by a second Input_data, several of them can read their parts concurrently.
+*/
+
+class Input_data
+{
+public:
+
+   Input_data();
+
+   /// Opens (maps) the basket file.
+   bool open( const char* basket_filename );
+
+   /// Reads the baskets of source that start in [begin, end) (the offsets have to be line starts), source has to stay open.
+   void open_part( const Input_data& source, const size_t begin, const size_t end );
+
+   /// Reads in one transaction from the datafile.
+   bool read_in_a_line( vector<itemtype>& basket );
+
+   /// The next read_in_a_line will return the first basket of the file.
+   void rewind();
+
+   /// Returns the number of characters of the file.
+   size_t size() const {return data_size;}
+
+   /// Returns the offset of the basket that the next read_in_a_line returns.
+   size_t tell() const {return position-data;}
+
+   /// Restricts the reading to the baskets that start at the given increasing offsets (0: every basket is read), and rewinds.
+   void select_lines( const vector<size_t>* lines );
+
+   /// Releases the basket file.
+   void close();
+
+   ~Input_data();
+
+private:
+
+   /// Appends the items found in the characters [line_begin, line_end) to the basket.
+   static void tokenize( const char* line_begin, const char* line_end, vector<itemtype>& basket );
+
+   /// The first character of the file.
+   const char*       data;
+
+   /// The number of characters in the file.
+   size_t            data_size;
+
+   /// The first character that has not been read yet.
+   const char*       position;
+
+   /// True if data is a memory mapping, false if it points to buffer.
+   bool              mapped;
+
+   /// Holds the content of the file if it cannot be mapped.
+   vector<char>      buffer;
+
+   /// If not 0, only the baskets that start at these offsets are read.
+   const vector<size_t>* lines;
+
+   /// The index of the next offset in lines.
+   size_t            line_index;
+};
+
+#endif
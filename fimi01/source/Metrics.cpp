@@ -0,0 +1,207 @@
+/***************************************************************************
+                          Metrics.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#include "Metrics.hpp"
+#include <atomic>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <malloc.h>
+#include <sys/resource.h>
+
+/// The heap is accounted only after Metrics::account_heap, otherwise operator new and delete call malloc and free directly.
+static bool accounting = false;
+
+/// The bytes allocated by operator new and their peak. They are signed: a block allocated before the accounting
+/// started and deleted after it is subtracted, but it was never added.
+static atomic<long> heap_in_use( 0 ),
+                    heap_peak( 0 ),
+                    phase_heap_peak( 0 );
+
+static inline void raise_peak( atomic<long>& peak, const long bytes )
+{
+   long old_peak = peak.load( memory_order_relaxed );
+   while( old_peak < bytes && !peak.compare_exchange_weak( old_peak, bytes, memory_order_relaxed ) );
+}
+
+static inline void* allocate( const size_t size )
+{
+   void* block = malloc( size ? size : 1 );
+   if( accounting && block )
+   {
+      const long bytes = heap_in_use.fetch_add( malloc_usable_size( block ), memory_order_relaxed ) + malloc_usable_size( block );
+      raise_peak( heap_peak, bytes );
+      raise_peak( phase_heap_peak, bytes );
+   }
+   return block;
+}
+
+static inline void deallocate( void* block )
+{
+   if( accounting && block ) heap_in_use.fetch_sub( malloc_usable_size( block ), memory_order_relaxed );
+   free( block );
+}
+
+void* operator new( size_t size )
+{
+   void* block = allocate( size );
+   if( !block ) throw bad_alloc();
+   return block;
+}
+
+void* operator new[]( size_t size )
+{
+   void* block = allocate( size );
+   if( !block ) throw bad_alloc();
+   return block;
+}
+
+void* operator new( size_t size, const nothrow_t& ) noexcept {return allocate( size );}
+void* operator new[]( size_t size, const nothrow_t& ) noexcept {return allocate( size );}
+void operator delete( void* block ) noexcept {deallocate( block );}
+void operator delete[]( void* block ) noexcept {deallocate( block );}
+void operator delete( void* block, size_t ) noexcept {deallocate( block );}
+void operator delete[]( void* block, size_t ) noexcept {deallocate( block );}
+void operator delete( void* block, const nothrow_t& ) noexcept {deallocate( block );}
+void operator delete[]( void* block, const nothrow_t& ) noexcept {deallocate( block );}
+
+/// Returns the string as a JSON string literal.
+static string json_string( const string& text )
+{
+   string literal = "\"";
+   for( string::const_iterator it_char = text.begin(); it_char != text.end(); it_char++ )
+   {
+      if( *it_char == '"' || *it_char == '\\' ) literal += '\\';
+      if( (unsigned char) *it_char < 0x20 )
+      {
+         char escape[7];
+         snprintf( escape, sizeof(escape), "\\u%04x", *it_char );
+         literal += escape;
+      }
+      else literal += *it_char;
+   }
+   return literal + "\"";
+}
+
+static void write_time( ofstream& file, const char* name, const Metrics::Time& time )
+{
+   file << "\"" << name << "\": {\"wall\": " << time.wall << ", \"cpu\": " << time.cpu << "}";
+}
+
+void Metrics::begin_phase( const char* name, const unsigned long size )
+{
+   phases.push_back( Phase() );
+   phases.back().name = name;
+   phases.back().size = size;
+   phase_heap_peak.store( heap_in_use.load( memory_order_relaxed ), memory_order_relaxed );
+}
+
+/**
+  \param trie_bytes The memory of the trie (0 if there is no trie).
+*/
+void Metrics::end_phase( const unsigned long trie_bytes )
+{
+   phases.back().trie_bytes = trie_bytes;
+   phases.back().heap_bytes = heap_bytes();
+   phases.back().peak_heap_bytes = max( 0L, phase_heap_peak.load( memory_order_relaxed ) );
+   phases.back().peak_rss_bytes = peak_rss_bytes();
+}
+
+void Metrics::set_parameter( const string& name, const string& value )
+{
+   parameters.push_back( pair<string,string>( name, json_string( value ) ) );
+}
+
+void Metrics::set_parameter( const string& name, const double value )
+{
+   ostringstream number;
+   number << setprecision( 12 ) << value;
+   parameters.push_back( pair<string,string>( name, number.str() ) );
+}
+
+/**
+  \param filename The name of the JSON file.
+*/
+bool Metrics::write( const char* filename ) const
+{
+   Time total_time;
+   total.stop( total_time );
+   ofstream file( filename );
+   if( !file ) return false;
+   file << fixed << setprecision( 6 );
+   file << "{\n  \"parameters\": {";
+   for( vector< pair<string,string> >::const_iterator it_parameter = parameters.begin();
+        it_parameter != parameters.end(); it_parameter++ )
+      file << (it_parameter == parameters.begin() ? "" : ",") << "\n    " << json_string( it_parameter->first )
+           << ": " << it_parameter->second;
+   file << "\n  },\n  \"phases\": [";
+   for( vector<Phase>::const_iterator it_phase = phases.begin(); it_phase != phases.end(); it_phase++ )
+   {
+      file << (it_phase == phases.begin() ? "" : ",") << "\n    {\"phase\": " << json_string( it_phase->name )
+           << ", \"size\": " << it_phase->size << ", \"candidates\": " << it_phase->candidates
+           << ", \"frequent\": " << it_phase->frequent << ", \"baskets\": " << it_phase->baskets << ",\n     ";
+      write_time( file, "counting", it_phase->counting );
+      file << ", ";
+      write_time( file, "pruning", it_phase->pruning );
+      file << ",\n     ";
+      write_time( file, "generation", it_phase->generation );
+      file << ", ";
+      write_time( file, "output", it_phase->output );
+      file << ",\n     \"trie_bytes\": " << it_phase->trie_bytes << ", \"heap_bytes\": " << it_phase->heap_bytes
+           << ", \"peak_heap_bytes\": " << it_phase->peak_heap_bytes << ", \"peak_rss_bytes\": " << it_phase->peak_rss_bytes << "}";
+   }
+   file << "\n  ],\n  \"total\": {\"wall\": " << total_time.wall << ", \"cpu\": " << total_time.cpu
+        << ", \"peak_heap_bytes\": " << peak_heap_bytes() << ", \"peak_rss_bytes\": " << peak_rss_bytes()
+        << ", \"peak_worker_rss_bytes\": " << peak_worker_rss_bytes() << "}\n}\n";
+   return file.good();
+}
+
+double Metrics::wall_time()
+{
+   timespec time;
+   clock_gettime( CLOCK_MONOTONIC, &time );
+   return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+double Metrics::cpu_time()
+{
+   timespec time;
+   clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &time );
+   return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+void Metrics::account_heap()
+{
+   accounting = true;
+}
+
+unsigned long Metrics::heap_bytes()
+{
+   return max( 0L, heap_in_use.load( memory_order_relaxed ) );
+}
+
+unsigned long Metrics::peak_heap_bytes()
+{
+   return max( 0L, heap_peak.load( memory_order_relaxed ) );
+}
+
+unsigned long Metrics::peak_rss_bytes()
+{
+   rusage usage;
+   getrusage( RUSAGE_SELF, &usage );
+   return (unsigned long) usage.ru_maxrss * 1024;      // ru_maxrss is given in kbytes
+}
+
+unsigned long Metrics::peak_worker_rss_bytes()
+{
+   rusage usage;
+   getrusage( RUSAGE_CHILDREN, &usage );
+   return (unsigned long) usage.ru_maxrss * 1024;
+}
@@ -0,0 +1,131 @@
+/***************************************************************************
+                          Metrics.hpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <utility>
+using namespace std;
+
+/** Metrics collects the measurements of the phases of the mining and writes them into a JSON file.
+
+   A phase is the first scan, a level of APRIORI (the support counting, the deletion of the infrequent itemsets
+   and the generation of the candidates of the next level), or an extra scan of the sampling and partition modes.
+   The wall clock time and the CPU time (of every thread of the process) of the steps are measured separately.
+
+   The heap is measured by the global operator new and delete (see Metrics.cpp): after account_heap they add up the usable size
+   of the blocks, so every container of the program is counted with its real size (before it they call malloc and free directly).
+   The peak of the resident set size comes from getrusage.
+   The heap and the resident set size are those of the process itself: the worker processes of --workers are left out,
+   only the peak resident set size of the largest worker is written in the totals (once the workers have been waited for).
+*/
+class Metrics
+{
+public:
+
+   /// The wall clock time and the CPU time of a step in seconds.
+   struct Time
+   {
+      Time():wall(0),cpu(0) {}
+
+      double wall,
+             cpu;
+   };
+
+   /// Measures the time that elapsed since its construction (or the last start).
+   class Stopwatch
+   {
+   public:
+      Stopwatch() {start();}
+
+      void start() {wall_begin = wall_time(); cpu_begin = cpu_time();}
+
+      /// Adds the elapsed time to the given time.
+      void stop( Time& time ) const {time.wall += wall_time()-wall_begin; time.cpu += cpu_time()-cpu_begin;}
+
+   private:
+      double wall_begin,
+             cpu_begin;
+   };
+
+   /// The measurements of a phase.
+   struct Phase
+   {
+      Phase():size(0),candidates(0),frequent(0),baskets(0),trie_bytes(0),heap_bytes(0),peak_heap_bytes(0),peak_rss_bytes(0) {}
+
+      string        name;
+      /// The size of the largest candidates of the phase.
+      unsigned long size;
+      unsigned long candidates,
+                    frequent;
+      /// The number of baskets (or distinct stored baskets) that were given to the support counting.
+      unsigned long baskets;
+      Time          counting,
+                    pruning,
+                    generation,
+                    output;
+      /// The memory of the trie (see Trie::memory) at the end of the phase.
+      unsigned long trie_bytes;
+      unsigned long heap_bytes,
+                    peak_heap_bytes,
+                    peak_rss_bytes;
+   };
+
+   /// Starts a new phase, the peak of the heap is measured from here.
+   void begin_phase( const char* name, const unsigned long size );
+
+   /// Returns the actual phase.
+   Phase& phase() {return phases.back();}
+
+   /// Records the heap and the resident set size at the end of the actual phase.
+   void end_phase( const unsigned long trie_bytes = 0 );
+
+   /// Appends the phases of another Metrics.
+   void append( const Metrics& metrics ) {phases.insert( phases.end(), metrics.phases.begin(), metrics.phases.end() );}
+
+   /// Records a parameter of the run, the value is written as a JSON string.
+   void set_parameter( const string& name, const string& value );
+
+   /// Records a numeric parameter of the run.
+   void set_parameter( const string& name, const double value );
+
+   /// Writes the parameters, the phases and the totals of the run, returns false if the file cannot be written.
+   bool write( const char* filename ) const;
+
+   /// Returns the seconds of the monotonic clock.
+   static double wall_time();
+
+   /// Returns the CPU seconds used by the process.
+   static double cpu_time();
+
+   /// Starts the accounting of the heap. It should be called before the mining starts its threads and workers.
+   static void account_heap();
+
+   /// Returns the bytes allocated on the heap by operator new since account_heap.
+   static unsigned long heap_bytes();
+
+   /// Returns the peak of heap_bytes since the program started.
+   static unsigned long peak_heap_bytes();
+
+   /// Returns the peak of the resident set size in bytes.
+   static unsigned long peak_rss_bytes();
+
+   /// Returns the peak of the resident set size of the largest terminated and waited for child process in bytes.
+   static unsigned long peak_worker_rss_bytes();
+
+private:
+
+   vector<Phase>                  phases;
+
+   /// The names and the JSON values of the parameters.
+   vector< pair<string,string> >  parameters;
+
+   /// The beginning of the run (the construction of the Metrics).
+   Stopwatch                      total;
+};
+
+#endif
@@ -0,0 +1,227 @@
+/***************************************************************************
+                          Pair_counter.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#include "Pair_counter.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+Pair_counter::Pair_counter()
+{
+   dense = true;
+   item_number = 0;
+   block_number = 0;
+   pair_number = 0;
+}
+
+/**
+  \param item_number_in The number of frequent items.
+  \param supports supports[i] is the occurrence of item i (i=1 ... item_number_in).
+  \param basket_number The number of baskets.
+*/
+void Pair_counter::init( const itemtype item_number_in, const vector<unsigned long>& supports, const unsigned long basket_number )
+{
+   clear();
+   item_number = item_number_in;
+   block_number = (item_number+tile_size-1)/tile_size;
+
+   const unsigned long triangle_bytes = block_number*(block_number+1)/2*tile_size*tile_size*sizeof(unsigned int);
+   if( basket_number > UINT_MAX ) dense = false;            // 32-bit counters could overflow
+   else if( triangle_bytes <= small_triangle ) dense = true;
+   else
+   {
+      double        expected_density = 0;
+      unsigned long random = 88172645463325252UL;
+      for( unsigned long sample_index = 0; sample_index < sample_size; sample_index++ )
+      {
+         random ^= random << 13; random ^= random >> 7; random ^= random << 17;
+         itemtype item_1 = 1 + random % item_number;
+         random ^= random << 13; random ^= random >> 7; random ^= random << 17;
+         itemtype item_2 = 1 + random % item_number;
+         if( item_1 == item_2 ) continue;
+         expected_density += 1 - exp( -((double) supports[item_1]) * supports[item_2] / basket_number );
+      }
+      expected_density /= sample_size;
+      // a pair of the hash table needs two words and the table is at most half full
+      const double hash_bytes = expected_density * item_number * (item_number-1) / 2 * 4 * sizeof(unsigned long);
+      dense = triangle_bytes <= hash_bytes;
+   }
+
+   if( dense ) triangle.assign( triangle_bytes/sizeof(unsigned int), 0 );
+   else
+   {
+      hash_keys.assign( 1024, 0 );
+      hash_counters.assign( 1024, 0 );
+   }
+}
+
+unsigned long Pair_counter::find_slot( const unsigned long key ) const
+{
+   const unsigned long mask = hash_keys.size()-1;
+   unsigned long       slot = (key * 11400714819323198485UL) >> 20 & mask;
+   while( hash_keys[slot] && hash_keys[slot] != key ) slot = (slot+1) & mask;
+   return slot;
+}
+
+void Pair_counter::grow_hash_table()
+{
+   vector<unsigned long> old_keys( 2*hash_keys.size(), 0 ),
+                         old_counters( 2*hash_counters.size(), 0 );
+   old_keys.swap( hash_keys );
+   old_counters.swap( hash_counters );
+   for( unsigned long old_slot = 0; old_slot < old_keys.size(); old_slot++ )
+      if( old_keys[old_slot] )
+      {
+         const unsigned long slot = find_slot( old_keys[old_slot] );
+         hash_keys[slot] = old_keys[old_slot];
+         hash_counters[slot] = old_counters[old_slot];
+      }
+}
+
+/**
+  \param basket_begin The first item of the basket (items are in increasing order).
+  \param basket_end The end of the basket.
+  \param counter The number the basket occures in the transactional database.
+*/
+template <class ITEM> void Pair_counter::add( const ITEM* basket_begin, const ITEM* basket_end, const unsigned long counter )
+{
+   const ITEM *it1_basket,
+              *it2_basket;
+   if( dense )
+   {
+      for( it1_basket = basket_begin; it1_basket != basket_end-1; it1_basket++ )
+      {
+         unsigned int* row = triangle.data() + tile_row( (*it1_basket-1)/tile_size ) + (*it1_basket-1)%tile_size*tile_size;
+         for( it2_basket = it1_basket+1; it2_basket != basket_end; it2_basket++ )
+            row[((*it2_basket-1)/tile_size)*tile_size*tile_size + (*it2_basket-1)%tile_size] += counter;
+      }
+   }
+   else
+   {
+      for( it1_basket = basket_begin; it1_basket != basket_end-1; it1_basket++ )
+         for( it2_basket = it1_basket+1; it2_basket != basket_end; it2_basket++ )
+            add_to_hash_table( ((unsigned long) *it1_basket << 32) | *it2_basket, counter );
+   }
+}
+
+template void Pair_counter::add( const unsigned short*, const unsigned short*, const unsigned long );
+template void Pair_counter::add( const unsigned int*, const unsigned int*, const unsigned long );
+template void Pair_counter::add( const unsigned long*, const unsigned long*, const unsigned long );
+
+unsigned long Pair_counter::get( const itemtype item_1, const itemtype item_2 ) const
+{
+   if( dense ) return triangle[triangle_index( item_1, item_2 )];
+   else return hash_counters[find_slot( ((unsigned long) item_1 << 32) | item_2 )];
+}
+
+/**
+  \param min_occurrence The occurence threshold.
+  \param first_items The smaller items of the frequent pairs.
+  \param second_items The larger items of the frequent pairs.
+  \param counters The occurrences of the frequent pairs.
+*/
+void Pair_counter::frequent_pairs( const unsigned long min_occurrence, vector<itemtype>& first_items,
+                                   vector<itemtype>& second_items, vector<unsigned long>& counters ) const
+{
+   first_items.clear();
+   second_items.clear();
+   counters.clear();
+   if( dense )
+   {
+      for( itemtype item_1 = 1; item_1 < item_number; item_1++ )
+         for( itemtype item_2 = item_1+1; item_2 <= item_number; item_2++ )
+            if( triangle[triangle_index( item_1, item_2 )] >= min_occurrence )
+            {
+               first_items.push_back( item_1 );
+               second_items.push_back( item_2 );
+               counters.push_back( triangle[triangle_index( item_1, item_2 )] );
+            }
+   }
+   else
+   {
+      vector<unsigned long> keys;
+      for( unsigned long slot = 0; slot < hash_keys.size(); slot++ )
+         if( hash_keys[slot] && hash_counters[slot] >= min_occurrence ) keys.push_back( hash_keys[slot] );
+      sort( keys.begin(), keys.end() );
+      for( vector<unsigned long>::const_iterator it_key = keys.begin(); it_key != keys.end(); it_key++ )
+      {
+         first_items.push_back( *it_key >> 32 );
+         second_items.push_back( *it_key & 0xffffffffUL );
+         counters.push_back( hash_counters[find_slot( *it_key )] );
+      }
+   }
+}
+
+/**
+  The triangle is read tile by tile, its entries that do not belong to a pair stay 0.
+  \param min_occurrence The smaller occurrences are skipped (it is positive).
+  \param k The size of the heap.
+  \param heap The heap of the k largest supports.
+*/
+void Pair_counter::top_supports( const unsigned long min_occurrence, const unsigned long k, vector<unsigned long>& heap ) const
+{
+   if( dense )
+   {
+      for( vector<unsigned int>::const_iterator it_counter = triangle.begin(); it_counter != triangle.end(); it_counter++ )
+         if( *it_counter >= min_occurrence ) add_top_support( heap, k, *it_counter );
+   }
+   else
+   {
+      for( unsigned long slot = 0; slot < hash_keys.size(); slot++ )
+         if( hash_keys[slot] && hash_counters[slot] >= min_occurrence ) add_top_support( heap, k, hash_counters[slot] );
+   }
+}
+
+/**
+  \param counters The counters are appended to it.
+*/
+void Pair_counter::get_counters( vector<unsigned long>& counters ) const
+{
+   if( dense ) counters.insert( counters.end(), triangle.begin(), triangle.end() );
+   else
+      for( unsigned long slot = 0; slot < hash_keys.size(); slot++ )
+         if( hash_keys[slot] )
+         {
+            counters.push_back( hash_keys[slot] );
+            counters.push_back( hash_counters[slot] );
+         }
+}
+
+/**
+  \param counters The counters given by get_counters of a Pair_counter of the same representation.
+  \param add If false, the counters are cleared first.
+*/
+void Pair_counter::set_counters( const vector<unsigned long>& counters, const bool add )
+{
+   if( dense )
+   {
+      for( unsigned long counter_index = 0; counter_index < triangle.size(); counter_index++ )
+         triangle[counter_index] = (add ? triangle[counter_index] : 0) + counters[counter_index];
+   }
+   else
+   {
+      if( !add )
+      {
+         hash_keys.assign( hash_keys.size(), 0 );
+         hash_counters.assign( hash_counters.size(), 0 );
+         pair_number = 0;
+      }
+      for( unsigned long position = 0; position < counters.size(); position += 2 )
+         add_to_hash_table( counters[position], counters[position+1] );
+   }
+}
+
+unsigned long Pair_counter::memory() const
+{
+   return triangle.capacity()*sizeof(unsigned int) + (hash_keys.capacity()+hash_counters.capacity())*sizeof(unsigned long);
+}
+
+void Pair_counter::clear()
+{
+   vector<unsigned int>().swap( triangle );
+   vector<unsigned long>().swap( hash_keys );
+   vector<unsigned long>().swap( hash_counters );
+   pair_number = 0;
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+                          Pair_counter.hpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#ifndef PAIR_COUNTER_H
+#define PAIR_COUNTER_H
+
+#include "Trie.hpp"
+
+/** Pair_counter stores the occurrences of the candidate itempairs.
+
+   Every pair of frequent items is a candidate of size 2, so there are n(n-1)/2 counters for n frequent items.
+   Two representations are used:
+   <ol>
+     <li> a packed triangular array of 32-bit counters. The triangle is cut into tiles of tile_size x tile_size pairs
+          and each tile is stored contiguously, so the pairs of the most frequent items (the largest codes) share a few tiles;</li>
+     <li> an open addressing hash table that stores only the pairs that occur at least once.</li>
+   </ol>
+   The triangle is used if it is small, or if the pairs are expected to be dense, but never for more than UINT_MAX baskets:
+   then a support (or the sum of the counters of the workers) may not fit into 32 bits.
+   The density is estimated by sampling pairs of frequent items and computing the probability that
+   they occur together at least once, supposing that the items are independent.
+*/
+
+class Pair_counter
+{
+public:
+
+   Pair_counter();
+
+   /// Chooses the representation and allocates the counters for the pairs of the items 1 ... item_number.
+   void init( const itemtype item_number, const vector<unsigned long>& supports, const unsigned long basket_number );
+
+   /// Increases the counter of every pair of the given basket (ITEM is the type of the item codes).
+   template <class ITEM> void add( const ITEM* basket_begin, const ITEM* basket_end, const unsigned long counter );
+
+   /// Returns the counter of the itempair (item_1, item_2), item_1 < item_2.
+   unsigned long get( const itemtype item_1, const itemtype item_2 ) const;
+
+   /// Collects the pairs that occur at least min_occurrence times, in increasing order.
+   void frequent_pairs( const unsigned long min_occurrence, vector<itemtype>& first_items,
+                        vector<itemtype>& second_items, vector<unsigned long>& counters ) const;
+
+   /// Adds the occurrences of the pairs that are at least min_occurrence to the heap of the k largest supports (see add_top_support).
+   void top_supports( const unsigned long min_occurrence, const unsigned long k, vector<unsigned long>& heap ) const;
+
+   /** Appends the counters to the given vector: the triangular array, or the key and the counter of every pair of the hash table.
+     *
+     * Pair_counters that are initialized with the same parameters have the same representation, so the counters of one of them
+     * can be added to another one by set_counters.
+     */
+   void get_counters( vector<unsigned long>& counters ) const;
+
+   /// Adds the counters of get_counters to the counters (or replaces them if add is false).
+   void set_counters( const vector<unsigned long>& counters, const bool add );
+
+   /// Returns true if the triangular array is used.
+   bool is_dense() const {return dense;}
+
+   /// Returns the memory need of the counters in bytes.
+   unsigned long memory() const;
+
+   /// Releases the counters.
+   void clear();
+
+private:
+
+   /// Returns the index of the first counter of tile row block_1 in triangle.
+   unsigned long tile_row( const unsigned long block_1 ) const
+   {
+      return (block_1*block_number - block_1*(block_1-1)/2 - block_1) * tile_size*tile_size;
+   }
+
+   /// Returns the index of the counter of the pair (item_1, item_2) in triangle, item_1 < item_2.
+   unsigned long triangle_index( const itemtype item_1, const itemtype item_2 ) const
+   {
+      return tile_row((item_1-1)/tile_size) + (((item_2-1)/tile_size)*tile_size + (item_1-1)%tile_size)*tile_size + (item_2-1)%tile_size;
+   }
+
+   /// Returns the slot of the pair key in the hash table (the slot of the pair or an empty slot).
+   unsigned long find_slot( const unsigned long key ) const;
+
+   /// Doubles the size of the hash table.
+   void grow_hash_table();
+
+   /// Increases the counter of the pair key in the hash table (the pair is inserted if it is not there).
+   void add_to_hash_table( const unsigned long key, const unsigned long counter )
+   {
+      const unsigned long slot = find_slot( key );
+      hash_counters[slot] += counter;
+      if( !hash_keys[slot] )
+      {
+         hash_keys[slot] = key;
+         if( 2*++pair_number > hash_keys.size() ) grow_hash_table();
+      }
+   }
+
+   /// The number of items in a row or a column of a tile.
+   static const unsigned long tile_size = 64;
+
+   /// The triangle is always used if it needs less bytes than this.
+   static const unsigned long small_triangle = 64*1048576UL;
+
+   /// The number of pairs that are sampled to estimate the pair density.
+   static const unsigned long sample_size = 4096;
+
+   bool                  dense;
+   itemtype              item_number;
+   unsigned long         block_number;
+
+   /// The counters of the tiles of the triangular array.
+   vector<unsigned int>  triangle;
+
+   /// The keys (item_1*2^32+item_2) of the hash table, 0 means an empty slot.
+   vector<unsigned long> hash_keys;
+
+   /// The counters of the hash table.
+   vector<unsigned long> hash_counters;
+
+   /// The number of pairs in the hash table.
+   unsigned long         pair_number;
+};
+
+#endif
@@ -0,0 +1,117 @@
+/***************************************************************************
+                          Result_writer.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#include "Result_writer.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+const char Result_writer::binary_magic[8] = {'F','I','M','I','B','I','N','1'};
+
+/**
+  \param outcomefile The file the itemsets will be written to.
+  \param format The format of the file.
+*/
+Result_writer::Result_writer( ofstream& outcomefile, const format_type format ):outcomefile(outcomefile),format(format)
+{
+}
+
+/**
+  \param items The items of the itemset.
+  \param itemset_size The number of the items.
+  \param support The occurrence of the itemset.
+*/
+void Result_writer::write_itemset( const itemtype* items, const itemtype itemset_size, const unsigned long support )
+{
+   if( buckets.size() <= itemset_size )
+   {
+      buckets.resize( itemset_size+1 );
+      spill_files.resize( itemset_size+1, 0 );
+      itemset_numbers.resize( itemset_size+1, 0 );
+   }
+   string& bucket = buckets[itemset_size];
+   itemset_numbers[itemset_size]++;
+   if( format == TEXT )
+   {
+      if( !itemset_size ) bucket.append( "{} " );
+      for( itemtype item_index = 0; item_index < itemset_size; item_index++ )
+      {
+         append_decimal( bucket, items[item_index] );
+         bucket.push_back( ' ' );
+      }
+      bucket.push_back( '(' );
+      append_decimal( bucket, support );
+      bucket.append( ")\n" );
+   }
+   else
+   {
+      sorted_items.assign( items, items+itemset_size );
+      sort( sorted_items.begin(), sorted_items.end() );
+      append_varint( bucket, itemset_size );
+      for( itemtype item_index = 0; item_index < itemset_size; item_index++ )
+         append_varint( bucket, item_index ? sorted_items[item_index]-sorted_items[item_index-1] : sorted_items[0] );
+      append_varint( bucket, support );
+   }
+   if( bucket.size() > bucket_limit ) spill( itemset_size );
+}
+
+/**
+  If no temporary file can be created, the bucket stays in the memory.
+*/
+void Result_writer::spill( const itemtype itemset_size )
+{
+   if( !spill_files[itemset_size] && !(spill_files[itemset_size] = tmpfile()) ) return;
+   if( fwrite( buckets[itemset_size].data(), 1, buckets[itemset_size].size(), spill_files[itemset_size] ) != buckets[itemset_size].size() )
+   {
+      cerr << "\nError!\n The temporary file of the itemsets can not be written.\n";
+      exit(1);
+   }
+   buckets[itemset_size].clear();
+}
+
+void Result_writer::finish()
+{
+   vector<char> block( bucket_limit );
+   if( format == BINARY ) outcomefile.write( binary_magic, sizeof(binary_magic) );
+   for( itemtype itemset_size = 0; itemset_size < buckets.size(); itemset_size++ )
+   {
+      if( format == TEXT ) outcomefile << "Frequent " << itemset_size << "-itemsets:\nitemset (occurrence)\n";
+      if( spill_files[itemset_size] )
+      {
+         size_t block_size;
+         rewind( spill_files[itemset_size] );
+         while( (block_size = fread( block.data(), 1, block.size(), spill_files[itemset_size] )) > 0 )
+            outcomefile.write( block.data(), block_size );
+         fclose( spill_files[itemset_size] );
+         spill_files[itemset_size] = 0;
+      }
+      outcomefile.write( buckets[itemset_size].data(), buckets[itemset_size].size() );
+      string().swap( buckets[itemset_size] );
+   }
+   outcomefile.flush();
+}
+
+void Result_writer::append_decimal( string& bucket, unsigned long number )
+{
+   char digits[24];
+   int  digit_index = sizeof(digits);
+   do digits[--digit_index] = '0' + number%10; while( number /= 10 );
+   bucket.append( digits+digit_index, sizeof(digits)-digit_index );
+}
+
+void Result_writer::append_varint( string& bucket, unsigned long number )
+{
+   while( number >= 0x80 )
+   {
+      bucket.push_back( (char) ((number & 0x7f) | 0x80) );
+      number >>= 7;
+   }
+   bucket.push_back( (char) number );
+}
+
+Result_writer::~Result_writer()
+{
+   for( itemtype itemset_size = 0; itemset_size < spill_files.size(); itemset_size++ )
+      if( spill_files[itemset_size] ) fclose( spill_files[itemset_size] );
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+                          Result_writer.hpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include "Trie.hpp"
+#include <string>
+
+/** Result_writer writes the frequent itemsets to the outcome file.
+
+<p>
+The itemsets can be given in any order (for example in the order of a single depth-first traversal), they are written grouped by their size.
+Every size has its own bucket. A bucket that grows over bucket_limit bytes is appended to a temporary file,
+and finish copies the temporary files and the buckets to the outcome file in large blocks.
+The numbers are formatted by hand, since there can be hundreds of millions of itemsets.
+</p>
+
+<p>
+Two formats are supported:
+<ol>
+  <li> TEXT: the format of the original program. Each size starts with the lines <tt>Frequent k-itemsets:</tt> and
+       <tt>itemset (occurrence)</tt>, then each line contains the items of an itemset and the occurrence in parentheses;</li>
+  <li> BINARY: the file starts with binary_magic, then each itemset is a record of unsigned LEB128 varints:
+       the size k, the smallest item, the k-1 differences of the consecutive items (in increasing order) and the occurrence.
+       The records of the same size follow each other as in the text format.
+       recode_reformat/read_itemsets converts the binary format to text.</li>
+</ol>
+</p>
+*/
+
+class Result_writer
+{
+public:
+
+   /// The formats of the outcome file.
+   enum format_type {TEXT, BINARY};
+
+   Result_writer( ofstream& outcomefile, const format_type format = TEXT );
+
+   /// Adds an itemset (the items are the original items, not the codes).
+   void write_itemset( const itemtype* items, const itemtype itemset_size, const unsigned long support );
+
+   /// Returns the size of the largest itemset written so far.
+   itemtype max_size() const {return itemset_numbers.empty() ? 0 : itemset_numbers.size()-1;}
+
+   /// Returns the number of itemsets of the given size written so far.
+   unsigned long itemset_number( const itemtype itemset_size ) const
+   {
+      return itemset_size < itemset_numbers.size() ? itemset_numbers[itemset_size] : 0;
+   }
+
+   /// Writes the buckets to the outcome file.
+   void finish();
+
+   ~Result_writer();
+
+   /// The first bytes of a binary outcome file.
+   static const char binary_magic[8];
+
+private:
+
+   /// Appends the bucket of the given size to its temporary file.
+   void spill( const itemtype itemset_size );
+
+   /// Appends an unsigned number in decimal to the bucket.
+   static void append_decimal( string& bucket, unsigned long number );
+
+   /// Appends an unsigned number as LEB128 varint to the bucket.
+   static void append_varint( string& bucket, unsigned long number );
+
+   /// A bucket is spilled to its temporary file when it becomes larger than this many bytes.
+   static const unsigned long bucket_limit = 1048576;
+
+   ofstream&             outcomefile;
+   format_type           format;
+
+   /// buckets[k] contains the itemsets of size k that are not spilled yet.
+   vector<string>        buckets;
+
+   /// spill_files[k] is the temporary file of the itemsets of size k (0 if bucket k has not been spilled).
+   vector<FILE*>         spill_files;
+
+   /// itemset_numbers[k] is the number of itemsets of size k.
+   vector<unsigned long> itemset_numbers;
+
+   /// The items of the actual binary record in increasing order.
+   vector<itemtype>      sorted_items;
+};
+
+#endif
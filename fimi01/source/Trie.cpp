@@ -8,19 +8,25 @@
 
 
 #include "Trie.hpp"
+#include "Pair_counter.hpp"
+#include "Result_writer.hpp"
+#include "Basket_tree.hpp"
 #include <cstdlib>
 #include <algorithm>
+#include <functional>
+#include <thread>
 
 /**
   \param stateIndex the state whose max_path value has to be set.
   \return true, if no update was required (original value was correct), otherwise false.
 */
 
-void Trie::max_path_set( const unsigned long stateIndex )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::max_path_set( const STATE stateIndex )
 {
-   itemtype temp_max_path = 0;
-   for(  vector<unsigned long>::iterator it_state = statearray[stateIndex].begin(); it_state != statearray[stateIndex].end(); it_state++ )
-      if( temp_max_path<maxpath[*it_state]+1) temp_max_path=maxpath[*it_state]+1;
+   ITEM temp_max_path = 0;
+   for( ITEM edge_index = 0; edge_index < itemarray[stateIndex].size(); edge_index++ )
+      if( temp_max_path<maxpath[statearray[stateIndex][edge_index]]+1) temp_max_path=maxpath[statearray[stateIndex][edge_index]]+1;
    if(  maxpath[stateIndex] != temp_max_path )
    {
       maxpath[stateIndex] = temp_max_path;
@@ -33,9 +39,10 @@ void Trie::max_path_set( const unsigned long stateIndex )
    \param toState the state to the edge points.
 */
 
-void Trie::delete_edge( const unsigned long fromState, const unsigned long toState )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::delete_edge( const STATE fromState, const STATE toState )
 {
-   vector<unsigned long>::iterator it_state = lower_bound( statearray[fromState].begin(), statearray[fromState].end(), toState );
+   typename vector<STATE>::iterator it_state = lower_bound( statearray[fromState].begin(), statearray[fromState].end(), toState );
    // we are sure, that there is an element, so if( it_state!=statearray[fromState].end() && *it_state==toState) is omitted
    itemarray[fromState].erase( it_state - statearray[fromState].begin() + itemarray[fromState].begin() );
    statearray[fromState].erase( it_state );
@@ -51,8 +58,14 @@ void Trie::delete_edge( const unsigned long fromState, const unsigned long toSta
   \param item The label of the new edge
   \param counter The initial counter of the new state
  */
-void Trie::add_empty_state( const unsigned long fromState,itemtype item, const unsigned long counter )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::add_empty_state( const STATE fromState,ITEM item, const COUNTER counter )
 {
+   if( itemarray.size() >= numeric_limits<STATE>::max() )
+   {
+      cerr << "\nError!\n The trie has more nodes than its state type can address.\n";
+      exit(1);
+   }
    itemarray[fromState].push_back(item);
    statearray[fromState].push_back(itemarray.size());
 
@@ -64,187 +77,466 @@ void Trie::add_empty_state( const unsigned long fromState,itemtype item, const u
 }
 
 /**
-  \param an_itemset The given itemset.
-  \return 0, if the itemset is not included, otherwise the state number, that represents the itemset.
+  \param stateIndex The given state.
+  \param item The label of the edge.
 */
-
-unsigned long Trie::is_included( const set<itemtype>& an_itemset ) const
-{
-   unsigned long                      stateIndex=0;
-   vector<itemtype>::const_iterator   it_itemvector;
-
-   for(  set<itemtype>::const_iterator item_it = an_itemset.begin(); item_it != an_itemset.end(); item_it++ )
-   {
-      it_itemvector = lower_bound(itemarray[stateIndex].begin(), itemarray[stateIndex].end(), *item_it);
-      if( it_itemvector != itemarray[stateIndex].end() && *it_itemvector == *item_it)
-         stateIndex = statearray[stateIndex][it_itemvector-itemarray[stateIndex].begin()];
-      else return 0;
-   }
-   return stateIndex;
-}
-
-/**
-  \param maybe_candidate The itemset that has to be checked.
- */
-
-bool Trie::is_all_subset_frequent( const set<itemtype>& maybe_candidate ) const
+template <class ITEM, class STATE, class COUNTER>
+STATE Trie<ITEM,STATE,COUNTER>::child( const STATE stateIndex, const ITEM item ) const
 {
-   if( maybe_candidate.size() < 3) return true;   // because of the candidate generation method!
-   else
-   {
-      set<itemtype>                 temp_itemset(maybe_candidate);
-      set<itemtype>::const_iterator item_it = --(--maybe_candidate.end());
-      do
-      {
-         item_it--;
-         temp_itemset.erase( *item_it );
-         if( !is_included( temp_itemset ) ) return false;
-         temp_itemset.insert( *item_it );
-      }
-      while ( item_it != maybe_candidate.begin() );
-      return true;
-   }
+   typename vector<ITEM>::const_iterator it_item = lower_bound( itemarray[stateIndex].begin(), itemarray[stateIndex].end(), item );
+   if( it_item != itemarray[stateIndex].end() && *it_item == item ) return statearray[stateIndex][it_item-itemarray[stateIndex].begin()];
+   else return 0;
 }
 
-void Trie::candidate_generation_two()
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::candidate_generation_two()
 {
    if(  !itemarray[0].empty() )
    {
       maxpath[0] = 2;
-      temp_counter_array.reserve(itemarray[0].size()-1);
-      temp_counter_array.resize(itemarray[0].size()-1);
-      for( itemtype stateIndex = 0; stateIndex < itemarray[0].size()-1; stateIndex++ )
-      {
-         temp_counter_array[stateIndex].reserve(itemarray[0].size()-1-stateIndex );
-         temp_counter_array[stateIndex].resize(itemarray[0].size()-1-stateIndex, 0);
-      }
+      vector<unsigned long> supports( countervector.begin(), countervector.begin()+itemarray[0].size()+1 );
+      temp_counter_array->init( itemarray[0].size(), supports, countervector[0] );   // the i-th item is represented by node i
    }
 }
 
-void Trie::candidate_generation_assist( unsigned long actual_state, const itemtype frequent_size,
-                                        const itemtype actual_size, set<itemtype>& maybe_candidate)
+/**
+  The candidates are generated from the nodes at depth frequent_size-1 (the leaves): for two children a<b of a leaf
+  the candidate is the prefix of the leaf extended by a and b.
+  A candidate is generated only if every subset that leaves out a prefix item is frequent (the other two subsets are).
+  The subset that leaves out the i<sup>th</sup> prefix item is the path of the first i items (path[i]) continued by the rest of the prefix, a and b.
+  The states of these subsets without b are determined once for every a (subset_states), so checking a candidate needs
+  only frequent_size-1 child lookups and no memory allocation.
+  The trie is only read, so several threads can collect candidates at the same time.
+  \param actual_state The actual node, it represents the items maybe_candidate[0] ... maybe_candidate[actual_size-2].
+  \param frequent_size The size of the frequent itemsets.
+  \param actual_size The depth of the actual node plus one.
+  \param work The path of the actual node and the work space.
+  \param buffer The collected candidates are appended to this buffer.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::collect_candidates( const STATE actual_state, const ITEM frequent_size, const ITEM actual_size,
+                                                   Generation_work& work, Candidate_buffer& buffer ) const
 {
-   itemtype edgeIndex;
+   if( maxpath[actual_state]+actual_size <= frequent_size ) return;     // there is no leaf with children under this node
+   ITEM edgeIndex;
+   vector<ITEM>&  items = work.child_items[actual_size-1];
+   vector<STATE>& states = work.child_states[actual_size-1];
+   get_children( actual_state, items, states );
+   work.path[actual_size-1] = actual_state;
    if( actual_size == frequent_size)
    {
-      itemtype edgeIndex2;
-      unsigned long toExtend;
-      for( edgeIndex = 0; edgeIndex < itemarray[actual_state].size(); edgeIndex++ )
+      ITEM edgeIndex2,
+           prefix_index,
+           subset_index;
+      buffer.leaves.push_back( actual_state );
+      for( edgeIndex = 0; edgeIndex < items.size(); edgeIndex++ )
       {
-         maybe_candidate.insert(itemarray[actual_state][edgeIndex]);
-         toExtend = statearray[actual_state][edgeIndex];
-         for( edgeIndex2 = edgeIndex+1; edgeIndex2 < itemarray[actual_state].size(); edgeIndex2++ )
+         buffer.extended.push_back( states[edgeIndex] );
+         work.maybe_candidate[actual_size-1] = items[edgeIndex];
+         for( subset_index = 0; subset_index < actual_size-1; subset_index++ )
          {
-            maybe_candidate.insert(itemarray[actual_state][edgeIndex2]);
-            if(  is_all_subset_frequent(maybe_candidate) )
-	       add_empty_state(toExtend,itemarray[actual_state][edgeIndex2]);
-            maybe_candidate.erase(itemarray[actual_state][edgeIndex2]);
+            STATE subset_state = work.path[subset_index];
+            for( prefix_index = subset_index+1; prefix_index < actual_size; prefix_index++ )
+               if( !(subset_state = child( subset_state, work.maybe_candidate[prefix_index] )) ) break;
+            if( !subset_state ) break;
+            work.subset_states[subset_index] = subset_state;
          }
-         if( !itemarray[toExtend].empty()) maxpath[toExtend] = 1;
-         vector<itemtype>((const vector<itemtype>) itemarray[toExtend]).swap(itemarray[toExtend]);         // we know that state toExtend will not have any more children!
-         vector<unsigned long>((const vector<unsigned long>) statearray[toExtend]).swap(statearray[toExtend]);  // we know that state toExtend will not have any more children!
-         maybe_candidate.erase(itemarray[actual_state][edgeIndex]);
+         if( subset_index == actual_size-1 )
+            for( edgeIndex2 = edgeIndex+1; edgeIndex2 < items.size(); edgeIndex2++ )
+            {
+               for( subset_index = 0; subset_index < actual_size-1; subset_index++ )
+                  if( !child( work.subset_states[subset_index], items[edgeIndex2] ) ) break;
+               if( subset_index == actual_size-1 ) buffer.items.push_back( items[edgeIndex2] );
+            }
+         buffer.item_ends.push_back( buffer.items.size() );
       }
-      max_path_set(actual_state);
+      buffer.leaf_ends.push_back( buffer.extended.size() );
    }
    else
    {
-      for( edgeIndex = 0; edgeIndex < itemarray[actual_state].size(); edgeIndex++ )
+      for( edgeIndex = 0; edgeIndex < items.size(); edgeIndex++ )
       {
-         maybe_candidate.insert(itemarray[actual_state][edgeIndex]);
-         candidate_generation_assist( statearray[actual_state][edgeIndex], frequent_size, actual_size+1, maybe_candidate );
-         maybe_candidate.erase(itemarray[actual_state][edgeIndex]);
+         work.maybe_candidate[actual_size-1] = items[edgeIndex];
+         collect_candidates( states[edgeIndex], frequent_size, actual_size+1, work, buffer );
       }
    }
 }
 
 /**
-   \param basket the given basket
-   */
+  \param frequent_size The size of the frequent itemsets.
+  \param root_items The labels of the children of the root.
+  \param root_states The children of the root.
+  \param queue The indices of the children of the root in decreasing order of their estimated cost.
+  \param next_task The position of the first task in queue that is not taken by any thread.
+  \param buffers buffers[i] receives the candidates of the subtree of the i<sup>th</sup> child of the root.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::collect_thread( const ITEM frequent_size, const vector<ITEM>* root_items, const vector<STATE>* root_states,
+                                               const vector<ITEM>* queue, atomic<unsigned long>* next_task,
+                                               vector<Candidate_buffer>* buffers ) const
+{
+   Generation_work work( frequent_size );
+   unsigned long   task;
+   while( (task = next_task->fetch_add( 1 )) < queue->size() )
+   {
+      const ITEM root_index = (*queue)[task];
+      work.maybe_candidate[0] = (*root_items)[root_index];
+      collect_candidates( (*root_states)[root_index], frequent_size, 2, work, (*buffers)[root_index] );
+   }
+}
 
-void Trie::find_candidate_one( const vector<itemtype>& basket )
+/**
+  The candidates are added in the order of the depth-first traversal, so the trie does not depend on the number of threads.
+  \param buffer The collected candidates.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::splice_candidates( const Candidate_buffer& buffer )
 {
-  countervector[0]++;
-  for( vector<itemtype>::const_iterator it_basket = basket.begin(); it_basket != basket.end(); it_basket++ )
-  {
-    if( *it_basket+1 >= countervector.size() ) countervector.resize( *it_basket+2, 0 );
-    countervector[*it_basket+1]++;
-  }
+   unsigned long extended_index = 0,
+                 item_index = 0;
+   for( unsigned long leaf_index = 0; leaf_index < buffer.leaves.size(); leaf_index++ )
+   {
+      for( ; extended_index < buffer.leaf_ends[leaf_index]; extended_index++ )
+      {
+         const STATE toExtend = buffer.extended[extended_index];
+         for( ; item_index < buffer.item_ends[extended_index]; item_index++ )
+            add_empty_state( toExtend, buffer.items[item_index] );
+         if( !itemarray[toExtend].empty()) maxpath[toExtend] = 1;
+         vector<ITEM>((const vector<ITEM>) itemarray[toExtend]).swap(itemarray[toExtend]);         // we know that state toExtend will not have any more children!
+         vector<STATE>((const vector<STATE>) statearray[toExtend]).swap(statearray[toExtend]);  // we know that state toExtend will not have any more children!
+      }
+      max_path_set( buffer.leaves[leaf_index] );
+   }
 }
 
 /**
-     \param basket the given basket
+     \param basket_begin the first item of the given basket
+     \param basket_end the end of the given basket
      \param counter The number the processed basket occures in the transactional database
    */
 
-void Trie::find_candidate_two( const vector<itemtype>& basket, const unsigned long counter )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::find_candidate_two( const ITEM* basket_begin, const ITEM* basket_end, const COUNTER counter )
 {
-   vector<itemtype>::const_iterator it1_basket,
-                                    it2_basket;
-
-   for( it1_basket = basket.begin(); it1_basket != basket.end()-1; it1_basket++)
-      for( it2_basket = it1_basket+1; it2_basket != basket.end(); it2_basket++)
-         temp_counter_array[*it1_basket-1][*it2_basket-*it1_basket-1] += counter;
+   temp_counter_array->add( basket_begin, basket_end, counter );
 }
 
 /**
-  \param basket the given basket
-  \param candidate_size The size of the candidates
   \param it_basket *it_basket lead to the actual_state. Only items following this item need to be considered
+  \param basket_end the end of the given basket
+  \param candidate_size The size of the largest candidates (the nodes at depth frozen.counted_size ... candidate_size are candidates)
   \param actual_state The index of the actual state
   \param actual_size The number of items that are already found
   \param counter The number the processed basket occures in the transactional database
+  \param context The counters of the found candidates are increased in this context.
+  \return The number of candidates found below the actual state (the actual state included)
 */
-void Trie::find_candidate_more( const vector<itemtype>& basket, const itemtype candidate_size,
-                                vector<itemtype>::const_iterator it_basket, const unsigned long actual_state,
-                                const itemtype actual_size, const unsigned long counter)
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie<ITEM,STATE,COUNTER>::find_candidate_more( const ITEM* it_basket, const ITEM* basket_end, const ITEM candidate_size,
+                                const STATE actual_state, const ITEM actual_size, const COUNTER counter,
+                                Counting_context<COUNTER>& context ) const
 {
+   context.visits[actual_size]++;
    if( candidate_size == actual_size)
-      countervector[actual_state] += counter;
+   {
+      context.add( actual_state-frozen.first_counted, counter );
+      return 1;
+   }
    else
    {
-      vector<itemtype>::iterator it_item = itemarray[actual_state].begin();
-      vector<unsigned long>::iterator it_state = statearray[actual_state].begin();
-      while( it_item < itemarray[actual_state].end() && candidate_size < basket.end()-it_basket+actual_size+1)
+      unsigned long found = 0,
+                    found_below,
+                    reach_size = frozen.counted_size;     // a child is visited only if the rest of the basket reaches this depth
+      if( actual_size >= reach_size )      // the levels are bundled
+      {
+         context.add( actual_state-frozen.first_counted, counter );
+         found = 1;
+         reach_size = actual_size+1;
+      }
+      context.items[actual_size] += basket_end-it_basket;
+      const unsigned long edge_begin = frozen.edge_begin[actual_state];
+      if( edge_begin & bitmap_flag )
+      {
+         const STATE*  bitmap = frozen.edge_child + (edge_begin & ~bitmap_flag);
+         const STATE*  children = bitmap + frozen.bitmap_words;
+         unsigned long position;
+         for( ; reach_size < (unsigned long) (basket_end-it_basket+actual_size+1); it_basket++ )
+            if( bitmap_find( bitmap, *it_basket, position ) )
+            {
+               found_below = find_candidate_more( it_basket+1, basket_end, candidate_size, children[position], actual_size+1, counter, context );
+               if( context.hits ) context.hits[basket_end-it_basket-1] += found_below;
+               found += found_below;
+            }
+      }
+      else
       {
-         if( *it_item < *it_basket) {it_item++; it_state++;}
-         else if( *it_item > *it_basket) it_basket++;
-         else
+         const ITEM*  it_item = frozen.edge_item + edge_begin;
+         const ITEM*  item_end = frozen.edge_item + (frozen.edge_begin[actual_state+1] & ~bitmap_flag);
+         const STATE* it_state = frozen.edge_child + edge_begin;
+         while( it_item < item_end && reach_size < (unsigned long) (basket_end-it_basket+actual_size+1) )
+         {
+            if( *it_item < *it_basket) {it_item++; it_state++;}
+            else if( *it_item > *it_basket) it_basket++;
+            else
+            {
+               found_below = find_candidate_more( it_basket+1, basket_end, candidate_size, *it_state, actual_size+1, counter, context );
+               if( context.hits ) context.hits[basket_end-it_basket-1] += found_below;
+               found += found_below;
+               it_item++;
+               it_state++;
+               it_basket++;
+            }
+         }
+      }
+      return found;
+   }
+}
+
+/// A lookup in the occurrence lists of the basket tree costs about as much as scanning this many nodes of the tree.
+static const unsigned long occurrence_lookup_cost = 16;
+
+/**
+  When the last item of a candidate is found at a node of the basket tree, every basket of its subtree contains the candidate,
+  so the counter is increased by the weight of the node.
+  The nodes of the subtrees that carry the labels of the actual node are found in one of two ways, whichever is cheaper:
+  <ol>
+    <li> every label is looked up in the occurrence lists of the tree. For the last item of the candidates
+         only the sum of the weights is needed, the nodes are not visited;</li>
+    <li> the subtrees are scanned, and the child of the actual node is looked up for every node (the items of the subtrees are not sorted)
+         by the bitmap index, or in a table of the context that is directly addressed by the items and is filled with the children
+         for the time of the scan. A subtree is skipped at once if its first item is larger than the last label
+         (the items grow along a path) or if it is not deep enough for the missing items.</li>
+  </ol>
+  \param tree The basket tree.
+  \param node_begin The first node of the subtrees.
+  \param node_end The end of the subtrees.
+  \param candidate_size The size of the candidates
+  \param actual_state The index of the actual state
+  \param actual_size The number of items that are already found
+  \param context The counters of the found candidates are increased in this context.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::find_candidate_tree( const Basket_tree<ITEM,COUNTER>& tree, const unsigned long node_begin,
+                                                    const unsigned long node_end, const ITEM candidate_size, const STATE actual_state,
+                                                    const ITEM actual_size, Counting_context<COUNTER>& context ) const
+{
+   const unsigned long edge_begin = frozen.edge_begin[actual_state],
+                       edge_end = frozen.edge_begin[actual_state+1] & ~bitmap_flag;
+   const STATE*        bitmap = (edge_begin & bitmap_flag) ? frozen.edge_child + (edge_begin & ~bitmap_flag) : 0;
+   const ITEM*         item_begin = frozen.edge_item + (edge_begin & ~bitmap_flag) + (bitmap ? frozen.bitmap_words : 0);
+   const ITEM*         item_end = frozen.edge_item + edge_end;
+   const ITEM          missing = candidate_size-actual_size;
+   unsigned long       position;
+
+   context.visits[actual_size]++;
+   if( item_begin == item_end ) return;
+   if( (unsigned long) (item_end-item_begin)*occurrence_lookup_cost < node_end-node_begin )
+   {
+      unsigned long first, last;
+      context.items[actual_size] += item_end-item_begin;
+      for( const ITEM* it_item = item_begin; it_item != item_end; it_item++ )
+      {
+         tree.find_occurrences( *it_item, node_begin, node_end, first, last );
+         if( first == last ) continue;
+         const STATE child_state = frozen.edge_child[it_item-frozen.edge_item];
+         if( missing == 1 )
+         {
+            context.visits[candidate_size]++;
+            context.add( child_state-frozen.first_counted, tree.weight_sum( first, last ) );
+         }
+         else for( ; first < last; first++ )
+            if( tree.height(tree.occurrence(first)) >= missing )
+               find_candidate_tree( tree, tree.occurrence(first)+1, tree.subtree_end(tree.occurrence(first)), candidate_size,
+                                    child_state, actual_size+1, context );
+      }
+      return;
+   }
+   context.items[actual_size] += node_end-node_begin;
+   unsigned long* children = 0;
+   if( !bitmap )
+   {
+      children = context.children.data() + (unsigned long) actual_size*(itemarray[0].size()+1);
+      for( const ITEM* it_item = item_begin; it_item != item_end; it_item++ ) children[*it_item] = frozen.edge_child[it_item-frozen.edge_item];
+   }
+   for( unsigned long node = node_begin; node < node_end; )
+   {
+      if( tree.item(node) > item_end[-1] || tree.height(node) < missing ) {node = tree.subtree_end(node); continue;}
+      STATE child_state = 0;
+      if( !bitmap ) child_state = children[tree.item(node)];
+      else if( bitmap_find( bitmap, tree.item(node), position ) ) child_state = bitmap[frozen.bitmap_words+position];
+      if( child_state )
+      {
+         if( missing == 1 )
+         {
+            context.visits[candidate_size]++;
+            context.add( child_state-frozen.first_counted, tree.weight(node) );
+         }
+         else find_candidate_tree( tree, node+1, tree.subtree_end(node), candidate_size, child_state, actual_size+1, context );
+      }
+      node++;
+   }
+   if( !bitmap )
+      for( const ITEM* it_item = item_begin; it_item != item_end; it_item++ ) children[*it_item] = 0;
+}
+
+/**
+  \param stateIndex The given state.
+  \param items The labels of the edges that start from the state.
+  \param states The end nodes of the edges.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::get_children( const STATE stateIndex, vector<ITEM>& items, vector<STATE>& states ) const
+{
+   items = itemarray[stateIndex];
+   states.assign( statearray[stateIndex].begin(), statearray[stateIndex].begin()+itemarray[stateIndex].size() );
+}
+
+/**
+  Only the nodes that lie on a path of length counted_size (at least) from the root are copied, in BFS order.
+  The nodes at depth counted_size ... candidate_size are counted, they are the last nodes of the image.
+  Usually counted_size is candidate_size, so every path of the image has the same length.
+  \param candidate_size The size of the largest candidates that will be counted.
+  \param counted_size The size of the smallest candidates that will be counted.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::freeze( const ITEM candidate_size, const ITEM counted_size )
+{
+   vector<STATE>         order( 1, 0 ),
+                         child_states;
+   vector<ITEM>          order_depth( 1, 0 ),
+                         child_items;
+   unsigned long         edge_number = 0,
+                         order_index;
+
+   thaw();
+   for( order_index = 0; order_index < order.size(); order_index++ )
+   {
+      if( order_depth[order_index] == candidate_size ) continue;
+      const STATE state_index = order[order_index];
+      get_children( state_index, child_items, child_states );
+      edge_number += child_items.size() + bitmap_words( bitmap_size(state_index) );
+      for( unsigned long edge_index = 0; edge_index < child_states.size(); edge_index++ )
+         if( maxpath[child_states[edge_index]]+order_depth[order_index]+1 >= counted_size )
          {
-            if( maxpath[*it_state]+actual_size+1 == candidate_size )
-               find_candidate_more( basket, candidate_size, it_basket+1, *it_state, actual_size+1, counter);
-            it_item++;
-            it_state++;
-            it_basket++;
+            order.push_back( child_states[edge_index] );
+            order_depth.push_back( order_depth[order_index]+1 );
          }
+   }
+   frozen.node_number = order.size();
+   frozen.level_begin.assign( candidate_size+2, frozen.node_number );
+   for( order_index = frozen.node_number; order_index-- > 0; ) frozen.level_begin[order_depth[order_index]] = order_index;
+   frozen.first_counted = frozen.level_begin[counted_size];
+   frozen.counted_size = counted_size;
+
+   const unsigned long item_words = arena_words<ITEM>( edge_number ),
+                       child_words = arena_words<STATE>( edge_number ),
+                       state_words = arena_words<STATE>( frozen.node_number ),
+                       counter_words = arena_words<COUNTER>( frozen.node_number-frozen.first_counted );
+   frozen.arena.assign( frozen.node_number+1 + item_words + child_words + state_words + counter_words, 0 );
+   frozen.edge_begin = frozen.arena.data();
+   frozen.edge_item  = (ITEM*) (frozen.edge_begin + frozen.node_number+1);
+   frozen.edge_child = (STATE*) (frozen.edge_begin + frozen.node_number+1 + item_words);
+   frozen.state      = (STATE*) (frozen.edge_begin + frozen.node_number+1 + item_words + child_words);
+   frozen.counters   = (COUNTER*) (frozen.edge_begin + frozen.node_number+1 + item_words + child_words + state_words);
+
+   unsigned long edge_end = 0,
+                 next_child = 1;
+   for( order_index = 0; order_index < frozen.node_number; order_index++ )
+   {
+      const STATE state_index = order[order_index];
+      frozen.state[order_index] = state_index;
+      frozen.edge_begin[order_index] = edge_end;
+      if( order_depth[order_index] == candidate_size ) continue;
+      get_children( state_index, child_items, child_states );
+      const unsigned long bitmap_begin = edge_end;
+      if( bitmap_size(state_index) )
+      {
+         frozen.edge_begin[order_index] |= bitmap_flag;
+         frozen.bitmap_words = bitmap_words( bitmap_size(state_index) );
+         edge_end += frozen.bitmap_words;
       }
+      for( unsigned long edge_index = 0; edge_index < child_states.size(); edge_index++ )
+         if( maxpath[child_states[edge_index]]+order_depth[order_index]+1 >= counted_size )
+         {
+            frozen.edge_item[edge_end] = child_items[edge_index];
+            frozen.edge_child[edge_end++] = next_child++;
+         }
+      if( frozen.edge_begin[order_index] & bitmap_flag )
+         build_bitmap( frozen.edge_item + bitmap_begin + frozen.bitmap_words, edge_end-bitmap_begin-frozen.bitmap_words,
+                       frozen.bitmap_words, frozen.edge_child + bitmap_begin );
    }
+   frozen.edge_begin[frozen.node_number] = edge_end;
+   frozen.context = counting_context();
+   profile.visits.assign( candidate_size+1, 0 );
+   profile.items.assign( candidate_size+1, 0 );
+   profile.supports.clear();
 }
 
 /**
+  \param items The labels in increasing order.
+  \param item_number The number of labels.
+  \param word_number The size of the index (bitmap_words() of the number of items it covers).
+  \param bitmap The index is written here.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::build_bitmap( const ITEM* items, const unsigned long item_number, const unsigned long word_number,
+                                             STATE* bitmap )
+{
+   fill( bitmap, bitmap+word_number, 0 );
+   for( unsigned long item_index = 0; item_index < item_number; item_index++ )
+      bitmap[2*(items[item_index]/bitmap_bits)] |= (STATE) 1 << (items[item_index]%bitmap_bits);
+   STATE rank = 0;
+   for( unsigned long word_index = 0; word_index < word_number; word_index += 2 )
+   {
+      bitmap[word_index+1] = rank;
+      rank += __builtin_popcountl( (unsigned long) bitmap[word_index] );
+   }
+}
+
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::thaw()
+{
+   for( unsigned long order_index = frozen.first_counted; order_index < frozen.node_number; order_index++ )
+      countervector[frozen.state[order_index]] += frozen.counters[order_index-frozen.first_counted];
+   if( frozen.node_number )
+   {
+      add_lookups( frozen.context );
+      profile.supports.assign( frozen.level_begin.size()-1, 0 );
+      for( unsigned long depth = 0; depth+1 < frozen.level_begin.size(); depth++ )
+         for( unsigned long order_index = frozen.level_begin[depth]; order_index < frozen.level_begin[depth+1]; order_index++ )
+            profile.supports[depth] += countervector[frozen.state[order_index]];
+   }
+   frozen = Frozen_trie();
+}
+
+/**
+  The items are coded by their frequency order, ties are broken by the item in decreasing order.
+  \param item_counters item_counters[i] is the occurrence of item i-1.
+  \param basket_number The number of (nonempty) baskets.
   \param min_occurrence The occurence threshold
 */
 
-void Trie::delete_infrequent_one( const unsigned long min_occurrence )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::set_first_level( const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                                                const unsigned long min_occurrence )
 {
    itemtype edgeIndex;
 
-   inv_orderarray.reserve( countervector.size() );
-   inv_orderarray.resize( countervector.size(), 0 );
+   countervector[0] = basket_number;
+   inv_orderarray.assign( item_counters.size(), 0 );
    orderarray.resize(1);
    vector<unsigned long> temp_countervector(1);
    vector<unsigned long>::iterator it_item;
 
-   for( edgeIndex = 1; edgeIndex < countervector.size(); edgeIndex++)
-      if( countervector[edgeIndex] >= min_occurrence )
+   for( edgeIndex = 1; edgeIndex < item_counters.size(); edgeIndex++)
+      if( item_counters[edgeIndex] >= min_occurrence )
       {
-         it_item = lower_bound( temp_countervector.begin()+1, temp_countervector.end(), countervector[edgeIndex]);
+         it_item = lower_bound( temp_countervector.begin()+1, temp_countervector.end(), item_counters[edgeIndex]);
          orderarray.insert(orderarray.begin()+(it_item-temp_countervector.begin()), edgeIndex);
-         temp_countervector.insert(it_item, countervector[edgeIndex]);
+         temp_countervector.insert(it_item, item_counters[edgeIndex]);
       }
    if( orderarray.size() > 1 ) maxpath[0] = 1;
    vector<itemtype>(orderarray).swap(orderarray);
-   countervector.resize(1);
    for( edgeIndex = 1; edgeIndex < orderarray.size(); edgeIndex++ )
       add_empty_state( 0, edgeIndex, temp_countervector[edgeIndex] );
    for( edgeIndex = 1; edgeIndex < orderarray.size(); edgeIndex++)
@@ -254,50 +546,54 @@ void Trie::delete_infrequent_one( const unsigned long min_occurrence )
 /**
   \param min_occurrence The occurence threshold
 */
-void Trie::delete_infrequent_two( const unsigned long min_occurrence )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::delete_infrequent_two( const unsigned long min_occurrence )
 {
-   itemtype stateIndex_1,
-            stateIndex_2;
-   for( stateIndex_1 = 1; stateIndex_1 < itemarray[0].size(); stateIndex_1++ )
+   vector<itemtype>      first_items,
+                         second_items;
+   vector<unsigned long> counters;
+   temp_counter_array->frequent_pairs( min_occurrence, first_items, second_items, counters );
+   temp_counter_array->clear();                                          /// temp_counter_array will never be used again!
+   for( unsigned long pair_index = 0; pair_index < counters.size(); pair_index++ )
    {
-      for( stateIndex_2 = 0; stateIndex_2 < itemarray[0].size()-stateIndex_1; stateIndex_2++ )
-        if( temp_counter_array[stateIndex_1-1][stateIndex_2] >= min_occurrence )
-           add_empty_state( stateIndex_1, stateIndex_1+stateIndex_2+1, temp_counter_array[stateIndex_1-1][stateIndex_2] );
-      if( !itemarray[stateIndex_1].empty() ) maxpath[stateIndex_1] = 1;
-      temp_counter_array[stateIndex_1-1].clear();
-      vector<unsigned long>().swap(temp_counter_array[stateIndex_1-1]);   /// temp_counter_array[stateIndex_1-1] will never be used again!
+      add_empty_state( first_items[pair_index], second_items[pair_index], counters[pair_index] );
+      maxpath[first_items[pair_index]] = 1;
    }
-   temp_counter_array.clear();
-   vector< vector<unsigned long> >().swap(temp_counter_array);            /// temp_counter_array will never be used again!
 
    if( itemarray.size() == itemarray[0].size()+1 ) maxpath[0] = 1;
 }
 
 /**
+  The states are compacted in increasing order, a parent is always moved before its children.
+  If the levels were bundled, the children of a deleted candidate are infrequent too (they are counted exactly), they are simply dropped.
+  Only the candidates (the states from first_candidate on) are checked, the frequent itemsets of the previous scans are kept.
   \param min_occurrence The occurence threshold
 */
-void Trie::delete_infrequent_more( const unsigned long min_occurrence )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::delete_infrequent_more( const unsigned long min_occurrence )
 {
-   unsigned long stateIndex=1,
-                 stateIndex2,
-                 os;
+   STATE stateIndex=1,
+         stateIndex2,
+         os;
+   vector<STATE> new_state( itemarray.size(), 0 );    // 0 for the deleted states (and the root)
 
    for( stateIndex2 = 1; stateIndex2 < itemarray.size(); stateIndex2++)
    {
-      os = parent[stateIndex2];
-      if( countervector[stateIndex2] >= min_occurrence )
+      if( parent[stateIndex2] && !new_state[parent[stateIndex2]] ) continue;     // the parent is deleted
+      os = new_state[parent[stateIndex2]];
+      if( stateIndex2 < first_candidate || countervector[stateIndex2] >= min_occurrence )
       {
          if( stateIndex != stateIndex2 )
          {
-            vector<unsigned long>::iterator it_state = lower_bound( statearray[os].begin(), statearray[os].end(), stateIndex2 );
+            typename vector<STATE>::iterator it_state = lower_bound( statearray[os].begin(), statearray[os].end(), stateIndex2 );
             *it_state = stateIndex;
             itemarray[stateIndex] = itemarray[stateIndex2];
             statearray[stateIndex] = statearray[stateIndex2];
-            parent[stateIndex] = parent[stateIndex2];
+            parent[stateIndex] = os;
             countervector[stateIndex] = countervector[stateIndex2];
             maxpath[stateIndex] = maxpath[stateIndex2];
          }
-         stateIndex++;
+         new_state[stateIndex2] = stateIndex++;
       }
       else delete_edge(os,stateIndex2);
    }
@@ -308,192 +604,683 @@ void Trie::delete_infrequent_more( const unsigned long min_occurrence )
    maxpath.resize( stateIndex );
 }
 
-void Trie::assoc_rule_find( ofstream& outcomefile, const double min_conf, set<itemtype>& condition_part,
-                            set<itemtype>& consequence_part, const unsigned long union_support) const
+/// The rules of a thread are written to the outcome file when they grow over this many bytes.
+static const unsigned long rule_buffer_size = 1048576;
+
+/// The frequent itemsets of this many subtrees of the root per thread are processed between two writes of the rules.
+static const unsigned long rule_tasks_per_thread = 16;
+
+/**
+  The conditions are enumerated in increasing order of their items, and the state of a condition is a child of the state of its prefix,
+  so the support of a condition is found by a single child lookup.
+  Since the confidence can only grow when the condition is extended, a condition whose rule is valid is not extended
+  (its extensions are not written, as in the original program); otherwise it is extended while the consequence has more than one item.
+  The lift is checked only for rules that have high enough confidence, the consequence is looked up starting from the longest prefix of the itemset that it contains.
+  \param work The actual itemset, the actual condition and the output.
+  \param itemset_size The size of the actual itemset.
+  \param first_position The position of the first item that can extend the condition.
+  \param condition_state The node that represents the condition (0 for the empty condition).
+  \param condition_size The size of the condition.
+  \param min_conf Confidence threshold.
+  \param min_lift Lift threshold (0 if there is none).
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::assoc_rule_find( Rule_work& work, const ITEM itemset_size, const ITEM first_position, const STATE condition_state,
+                                                const ITEM condition_size, const double min_conf, const double min_lift ) const
 {
-   set<itemtype>::const_iterator item_it_2;
-   itemtype                      item;
-   for( set<itemtype>::const_iterator item_it = consequence_part.begin(); item_it != consequence_part.end(); item_it++)
-   if( condition_part.empty() || *(--condition_part.end()) < *item_it)
+   const COUNTER union_support = countervector[work.path[itemset_size]];
+   for( ITEM position = first_position; position < itemset_size; position++ )
    {
-      item = *item_it;
-      consequence_part.erase( item );
-      condition_part.insert( item );
-      if( union_support > countervector[is_included(condition_part)] * min_conf)
+      const STATE new_condition = child( condition_state, work.itemset[position] );
+      work.in_condition[position] = true;
+      if( union_support > countervector[new_condition] * min_conf )
       {
-         outcomefile << endl;
-         for( item_it_2 = condition_part.begin(); item_it_2 != --(condition_part.end()); item_it_2++)
-            outcomefile << orderarray[*item_it_2]-1 << ' ';
-         outcomefile << orderarray[*item_it_2]-1;
-         outcomefile << " ==> ";
-         for( item_it_2 = consequence_part.begin(); item_it_2 != --(consequence_part.end()); item_it_2++)
-            outcomefile << orderarray[*item_it_2]-1 << ' ';
-         outcomefile << orderarray[*item_it_2]-1;
-         outcomefile << " ("<<((double) union_support) / countervector[is_included(condition_part)] << ", " << union_support << ')';
+         bool valid = true;
+         if( min_lift )
+         {
+            ITEM consequence_position = 0;
+            while( !work.in_condition[consequence_position] ) consequence_position++;
+            STATE consequence_state = work.path[consequence_position];
+            for( ; consequence_position < itemset_size; consequence_position++ )
+               if( !work.in_condition[consequence_position] ) consequence_state = child( consequence_state, work.itemset[consequence_position] );
+            valid = ((double) union_support) * countervector[0] >= min_lift * countervector[new_condition] * countervector[consequence_state];
+         }
+         if( valid )
+         {
+            char number[32];
+            ITEM item_position;
+            work.rules.push_back( '\n' );
+            for( item_position = 0; item_position < itemset_size; item_position++ )
+               if( work.in_condition[item_position] )
+               {
+                  snprintf( number, sizeof(number), "%lu ", (unsigned long) orderarray[work.itemset[item_position]]-1 );
+                  work.rules.append( number );
+               }
+            work.rules.append( "==>" );
+            for( item_position = 0; item_position < itemset_size; item_position++ )
+               if( !work.in_condition[item_position] )
+               {
+                  snprintf( number, sizeof(number), " %lu", (unsigned long) orderarray[work.itemset[item_position]]-1 );
+                  work.rules.append( number );
+               }
+            snprintf( number, sizeof(number), " (%g, ", ((double) union_support) / countervector[new_condition] );
+            work.rules.append( number );
+            snprintf( number, sizeof(number), "%lu)", (unsigned long) union_support );
+            work.rules.append( number );
+         }
       }
-      else if( consequence_part.size() > 1 ) assoc_rule_find( outcomefile, min_conf, condition_part, consequence_part, union_support );
-      item_it = (consequence_part.insert( item )).first;
-      condition_part.erase( item );
+      else if( itemset_size-condition_size > 2 )
+         assoc_rule_find( work, itemset_size, position+1, new_condition, condition_size+1, min_conf, min_lift );
+      work.in_condition[position] = false;
    }
 }
 
-void Trie::assoc_rule_assist( ofstream& outcomefile, const double min_conf, unsigned long actual_state, set<itemtype>& consequence_part) const
+/**
+  \param work The path of the actual node and the output.
+  \param actual_state The actual node.
+  \param actual_size The depth of the actual node.
+  \param min_conf Confidence threshold.
+  \param min_lift Lift threshold (0 if there is none).
+  \param min_occurrence The itemsets that occur less times are left out (with their subtries).
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::assoc_rule_assist( Rule_work& work, const STATE actual_state, const ITEM actual_size,
+                                                  const double min_conf, const double min_lift, const unsigned long min_occurrence ) const
 {
-   if( consequence_part.size() > 1 )
-   {
-      set<itemtype> condition_part;
-      assoc_rule_find( outcomefile, min_conf, condition_part, consequence_part, countervector[actual_state] );
-   }
-   vector<unsigned long>::const_iterator it_state = statearray[actual_state].begin();
-   for( vector<itemtype>::const_iterator it_item = itemarray[actual_state].begin(); it_item != itemarray[actual_state].end(); it_item++, it_state++)
+   work.path[actual_size] = actual_state;
+   if( actual_size > 1 )
    {
-      consequence_part.insert( *it_item );
-      assoc_rule_assist( outcomefile, min_conf, *it_state, consequence_part);
-      consequence_part.erase( *it_item );
+      assoc_rule_find( work, actual_size, 0, 0, 0, min_conf, min_lift );
+      if( work.outcomefile && work.rules.size() > rule_buffer_size )
+      {
+         work.outcomefile->write( work.rules.data(), work.rules.size() );
+         work.rules.clear();
+      }
    }
+   vector<ITEM>&  items = work.child_items[actual_size];
+   vector<STATE>& states = work.child_states[actual_size];
+   get_children( actual_state, items, states );
+   for( ITEM edge_index = 0; edge_index < items.size(); edge_index++ )
+      if( countervector[states[edge_index]] >= min_occurrence )
+      {
+         work.itemset[actual_size] = items[edge_index];
+         assoc_rule_assist( work, states[edge_index], actual_size+1, min_conf, min_lift, min_occurrence );
+      }
 }
-void Trie::write_content_to_file_assist( ofstream& outcomefile, const unsigned long actual_state, const itemtype item_size,
-                                         const itemtype actual_size, set<itemtype>& frequent_itemset) const
+
+/**
+  \param root_items The labels of the children of the root.
+  \param root_states The children of the root.
+  \param task_end The end of the tasks (indices of the children of the root) of the actual batch.
+  \param next_task The first task that is not taken by any thread.
+  \param rules (*rules)[i] receives the rules of the subtree of the (task_end-rules->size()+i)<sup>th</sup> child of the root.
+  \param min_conf Confidence threshold.
+  \param min_lift Lift threshold (0 if there is none).
+  \param min_occurrence The itemsets that occur less times are left out.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::assoc_rule_thread( const vector<ITEM>* root_items, const vector<STATE>* root_states, const unsigned long task_end,
+                                                  atomic<unsigned long>* next_task, vector<string>* rules,
+                                                  const double min_conf, const double min_lift, const unsigned long min_occurrence ) const
 {
-   if( actual_size == item_size )
+   Rule_work     work( maxpath[0] );
+   unsigned long task;
+   while( (task = next_task->fetch_add( 1 )) < task_end )
    {
-      for( set<itemtype>::const_iterator it = frequent_itemset.begin(); it != frequent_itemset.end(); it++)
-         outcomefile << orderarray[*it]-1 << ' ';
-      outcomefile << '(' << countervector[actual_state] << ')'<<endl;
+      work.itemset[0] = (*root_items)[task];
+      if( countervector[(*root_states)[task]] >= min_occurrence )
+         assoc_rule_assist( work, (*root_states)[task], 1, min_conf, min_lift, min_occurrence );
+      work.rules.swap( (*rules)[task-(task_end-rules->size())] );
+      work.rules.clear();
    }
-   else
-   {
-      vector<unsigned long>::const_iterator it_state = statearray[actual_state].begin();
-      for( vector<itemtype>::const_iterator it_item = itemarray[actual_state].begin(); it_item != itemarray[actual_state].end(); it_item++, it_state++ )
-      if( maxpath[*it_state]+actual_size+1 >= item_size )
+}
+
+/**
+  \param writer The itemsets are given to this writer.
+  \param actual_state The actual node.
+  \param actual_size The depth of the actual node.
+  \param frequent_itemset The items of the actual node (the original items, not the codes).
+  \param min_occurrence The itemsets that occur less times are left out (with their subtries).
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::write_content_to_file_assist( Result_writer& writer, const STATE actual_state, const ITEM actual_size,
+                                                             itemtype* frequent_itemset, const unsigned long min_occurrence ) const
+{
+   writer.write_itemset( frequent_itemset, actual_size, countervector[actual_state] );
+   typename vector<STATE>::const_iterator it_state = statearray[actual_state].begin();
+   for( typename vector<ITEM>::const_iterator it_item = itemarray[actual_state].begin(); it_item != itemarray[actual_state].end(); it_item++, it_state++ )
+      if( countervector[*it_state] >= min_occurrence )
       {
-         frequent_itemset.insert( *it_item );
-         write_content_to_file_assist( outcomefile, *it_state, item_size, actual_size+1, frequent_itemset);
-         frequent_itemset.erase( *it_item );
+         frequent_itemset[actual_size] = orderarray[*it_item]-1;
+         write_content_to_file_assist( writer, *it_state, actual_size+1, frequent_itemset, min_occurrence );
       }
-   }
 }
 
-Trie::Trie()
+template <class ITEM, class STATE, class COUNTER>
+Trie<ITEM,STATE,COUNTER>::Trie()
 {
+   temp_counter_array = new Pair_counter();
    countervector.push_back(0);
    maxpath.push_back(0);
    itemarray.resize(1);
    statearray.resize(1);
    parent.push_back(0);   //it could be anything, root doesn't have a parent!
+   first_candidate = 1;
 }
 
 /**
+  Candidate generation has two phases. The candidates of a subtree of the root are collected into a buffer
+  without modifying the trie, then they are spliced into the trie.
+  With one thread the subtrees are processed one after the other. With more threads the subtrees are taken from a common queue
+  in decreasing order of their estimated cost (the square of the number of children), so the subtrees of the
+  frequent items that have many frequent extensions are started first and the small ones balance the load at the end.
+  The buffers are spliced after all threads have finished, in the order of the subtrees.
+
+  If bundled is true, the itemsets of size frequent_size are candidates that are not counted yet, and the new candidates are
+  generated as if all of them were frequent. The frozen image then counts both levels in one pass over the baskets.
+  The exact counts decide afterwards: a new candidate that has an infrequent subset is infrequent itself, so delete_infrequent removes it.
   \param frequent_size Size of the frequent itemsets that generate the candidates.
+  \param threads The number of threads.
+  \param bundled True if the itemsets of size frequent_size are not counted yet.
 */
-void Trie::candidate_generation( const itemtype& frequent_size )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::candidate_generation( const ITEM& frequent_size, const unsigned threads, const bool bundled )
 {
    if( frequent_size == 1 ) candidate_generation_two();
    else if( maxpath[0] == frequent_size )
    {
-      set<itemtype> maybe_candidate;
-      candidate_generation_assist( 0, frequent_size, 1, maybe_candidate );
+      if( !bundled ) first_candidate = itemarray.size();
+      vector<ITEM>  root_items;
+      vector<STATE> root_states;
+      get_children( 0, root_items, root_states );
+      if( threads > 1 )
+      {
+         vector< pair<unsigned long,ITEM> > costs;
+         for( ITEM root_index = 0; root_index < root_states.size(); root_index++ )
+            if( maxpath[root_states[root_index]]+1 >= frequent_size )
+               costs.push_back( pair<unsigned long,ITEM>( (unsigned long) child_number(root_states[root_index])*child_number(root_states[root_index]),
+                                                          root_index ) );
+         stable_sort( costs.begin(), costs.end(), greater< pair<unsigned long,ITEM> >() );
+         vector<ITEM> queue;
+         for( typename vector< pair<unsigned long,ITEM> >::const_iterator it_cost = costs.begin(); it_cost != costs.end(); it_cost++ )
+            queue.push_back( it_cost->second );
+
+         vector<Candidate_buffer> buffers( root_states.size() );
+         vector<thread>           thread_pool;
+         atomic<unsigned long>    next_task( 0 );
+         for( unsigned thread_index = 0; thread_index < threads; thread_index++ )
+            thread_pool.push_back( thread( &Trie::collect_thread, this, frequent_size, &root_items, &root_states,
+                                           &queue, &next_task, &buffers ) );
+         for( unsigned thread_index = 0; thread_index < threads; thread_index++ ) thread_pool[thread_index].join();
+         for( ITEM root_index = 0; root_index < root_states.size(); root_index++ )
+         {
+            splice_candidates( buffers[root_index] );
+            buffers[root_index] = Candidate_buffer();     // releases the memory of the buffer
+         }
+      }
+      else
+      {
+         Generation_work  work( frequent_size );
+         Candidate_buffer buffer;
+         for( ITEM root_index = 0; root_index < root_states.size(); root_index++ )
+         {
+            work.maybe_candidate[0] = root_items[root_index];
+            collect_candidates( root_states[root_index], frequent_size, 2, work, buffer );
+            splice_candidates( buffer );
+            buffer.clear();
+         }
+      }
+      if( maxpath[0] == frequent_size+1 )
+      {
+         choose_representation( frequent_size+1 );
+         freeze( frequent_size+1, bundled ? frequent_size : frequent_size+1 );
+      }
+   }
+}
+
+/**
+  Two children a<b of a node at depth candidate_size-1 can make a candidate of size candidate_size+1,
+  so the bound is the sum of the number of pairs of these children.
+  \param candidate_size The size of the candidates (more than 1).
+*/
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie<ITEM,STATE,COUNTER>::candidate_bound( const ITEM candidate_size ) const
+{
+   vector< pair<STATE,ITEM> > stack( 1, pair<STATE,ITEM>(0, 0) );
+   vector<ITEM>               items;
+   vector<STATE>              states;
+   unsigned long              bound = 0;
+   while( !stack.empty() )
+   {
+      const STATE state_index = stack.back().first;
+      const ITEM  depth = stack.back().second;
+      stack.pop_back();
+      if( depth+1 == candidate_size )
+      {
+         const unsigned long children = child_number( state_index );
+         if( children > 1 ) bound += children*(children-1)/2;
+      }
+      else
+      {
+         get_children( state_index, items, states );
+         for( unsigned long edge_index = 0; edge_index < states.size(); edge_index++ )
+            if( maxpath[states[edge_index]]+depth+1 >= candidate_size ) stack.push_back( pair<STATE,ITEM>(states[edge_index], depth+1) );
+      }
+   }
+   return bound;
+}
+
+/**
+  \param basket_begin The first item of the basket.
+  \param basket_end The end of the basket.
+  \param candidate_size The size of the candidates.
+  \param counter The number the processed basket occures in the transactional database
+*/
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie<ITEM,STATE,COUNTER>::find_candidate( const ITEM* basket_begin, const ITEM* basket_end, const ITEM candidate_size,
+                                                        const COUNTER counter)
+{
+   if( candidate_size == 2 )
+   {
+      if( basket_end-basket_begin > 1 ) find_candidate_two( basket_begin, basket_end, counter );
+      return 0;
+   }
+   else return find_candidate( basket_begin, basket_end, candidate_size, counter, frozen.context );
+}
+
+/**
+  \param counters counters[i] is added to the counter of the i<sup>th</sup> candidate of the frozen trie.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::add_counters( const vector<COUNTER>& counters )
+{
+   for( unsigned long candidate_index = 0; candidate_index < counters.size(); candidate_index++ )
+      frozen.counters[candidate_index] += counters[candidate_index];
+}
+
+/**
+  \param counters The counters are appended to it, counters[i] is the counter of state first_candidate+i for the larger candidates.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::get_counters( vector<unsigned long>& counters ) const
+{
+   if( maxpath[0] == 2 ) temp_counter_array->get_counters( counters );
+   else
+   {
+      const unsigned long counters_begin = counters.size();
+      counters.insert( counters.end(), countervector.begin()+first_candidate, countervector.end() );
+      for( unsigned long order_index = frozen.first_counted; order_index < frozen.node_number; order_index++ )
+         counters[counters_begin+frozen.state[order_index]-first_candidate] += frozen.counters[order_index-frozen.first_counted];
+   }
+}
+
+/**
+  The counters of the larger candidates are put into the frozen image if it exists, so they are added to countervector by thaw.
+  \param counters The counters given by get_counters of a trie that contains the same itemsets.
+  \param add If false, the counters of the candidates are cleared first.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::set_counters( const vector<unsigned long>& counters, const bool add )
+{
+   if( maxpath[0] == 2 ) temp_counter_array->set_counters( counters, add );
+   else
+   {
+      if( !add ) fill( countervector.begin()+first_candidate, countervector.end(), 0 );
+      if( frozen.node_number )
+         for( unsigned long order_index = frozen.first_counted; order_index < frozen.node_number; order_index++ )
+         {
+            frozen.counters[order_index-frozen.first_counted] = add ? frozen.counters[order_index-frozen.first_counted] : 0;
+            frozen.counters[order_index-frozen.first_counted] += counters[frozen.state[order_index]-first_candidate];
+         }
+      else
+         for( STATE stateIndex = first_candidate; stateIndex < itemarray.size(); stateIndex++ )
+            countervector[stateIndex] += counters[stateIndex-first_candidate];
    }
 }
 
-void Trie::find_candidate( const vector<itemtype>& basket, const itemtype candidate_size, const unsigned long counter)
+/**
+  \param context A context that counted the frozen trie.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::add_lookups( const Counting_context<COUNTER>& context )
 {
-   if( candidate_size == 1 ) find_candidate_one( basket );
-   else if( candidate_size == 2 ) find_candidate_two( basket, counter );
-   else find_candidate_more( basket, candidate_size, basket.begin(), 0, 0, counter );
+   for( unsigned long depth = 0; depth < context.visits.size() && depth < profile.visits.size(); depth++ )
+   {
+      profile.visits[depth] += context.visits[depth];
+      profile.items[depth] += context.items[depth];
+   }
 }
 
 /**
+  Called after the support counting, before delete_infrequent. The pairs are read from the pair counters,
+  the larger candidates from the counters of the frozen image.
+  \param min_occurrence The smaller supports are skipped.
+  \param k The size of the heap.
+  \param heap The heap of the k largest supports.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::top_supports( const unsigned long min_occurrence, const unsigned long k, vector<unsigned long>& heap ) const
+{
+   if( maxpath[0] == 2 ) temp_counter_array->top_supports( min_occurrence, k, heap );
+   else
+      for( unsigned long candidate_index = 0; candidate_index < counter_number(); candidate_index++ )
+         if( frozen.counters[candidate_index] >= min_occurrence ) add_top_support( heap, k, frozen.counters[candidate_index] );
+}
+
+/**
+  Every subset of a candidate is frequent, so an infrequent candidate whose parent is frequent (or is not a candidate)
+  is a minimal infrequent itemset. The infrequent pairs are not collected, every pair of frequent items is a candidate.
   \param min_occurrence The threshold of absolute support.
+  \param border If it is not 0, the infrequent candidates of the negative border are appended to it.
 */
-void Trie::delete_infrequent( const unsigned long min_occurrence )
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::delete_infrequent( const unsigned long min_occurrence, vector<ITEM>* border )
 {
-   if( maxpath[0] == 0 ) delete_infrequent_one( min_occurrence );
-   else if( maxpath[0] == 2 ) delete_infrequent_two( min_occurrence );
-   else delete_infrequent_more( min_occurrence );
+   thaw();
+   if( maxpath[0] == 2 ) delete_infrequent_two( min_occurrence );
+   else
+   {
+      if( border )
+         for( STATE stateIndex = first_candidate; stateIndex < itemarray.size(); stateIndex++ )
+            if( countervector[stateIndex] < min_occurrence &&
+                (parent[stateIndex] < first_candidate || countervector[parent[stateIndex]] >= min_occurrence) )
+               append_itemset( stateIndex, *border );
+      delete_infrequent_more( min_occurrence );
+   }
 }
 
 /**
+  The items are collected from the state up to the root, the label of an edge is found by a binary search
+  among the (sorted) children of its parent.
+  \param state A state of the trie.
+  \param itemsets The vector the itemset is appended to.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::append_itemset( const STATE state, vector<ITEM>& itemsets ) const
+{
+   const unsigned long itemset_begin = itemsets.size();
+   for( STATE actual_state = state; actual_state; actual_state = parent[actual_state] )
+   {
+      const STATE parent_state = parent[actual_state];
+      itemsets.push_back( itemarray[parent_state][lower_bound( statearray[parent_state].begin(),
+                             statearray[parent_state].begin()+itemarray[parent_state].size(), actual_state )
+                          - statearray[parent_state].begin()] );
+   }
+   itemsets.push_back( itemsets.size()-itemset_begin );
+   reverse( itemsets.begin()+itemset_begin, itemsets.end() );
+}
+
+/**
+  \param itemsets The itemsets of size more than one are appended to it, each of them as its size followed by its items.
+  \return The number of the appended itemsets.
+*/
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie<ITEM,STATE,COUNTER>::get_itemsets( vector<ITEM>& itemsets ) const
+{
+   for( STATE stateIndex = itemarray[0].size()+1; stateIndex < itemarray.size(); stateIndex++ ) append_itemset( stateIndex, itemsets );
+   return itemarray.size()-itemarray[0].size()-1;
+}
+
+/// Returns true if the first itemset is lexicographically smaller than the second one (an itemset is given by its first and its end item).
+template <class ITEM> static bool itemset_less( const pair<const ITEM*,const ITEM*>& itemset_1, const pair<const ITEM*,const ITEM*>& itemset_2 )
+{
+   return lexicographical_compare( itemset_1.first, itemset_1.second, itemset_2.first, itemset_2.second );
+}
+
+/**
+  The itemsets are inserted in lexicographic order, so the new children of a node come in increasing order of their labels.
+  \param itemsets Each itemset is given by its size followed by its items in increasing order.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::add_itemsets( const vector<ITEM>& itemsets )
+{
+   vector< pair<const ITEM*,const ITEM*> > sorted_itemsets;
+   for( unsigned long position = 0; position < itemsets.size(); position += (unsigned long) itemsets[position]+1 )
+      sorted_itemsets.push_back( pair<const ITEM*,const ITEM*>( itemsets.data()+position+1,
+                                                                itemsets.data()+position+1+itemsets[position] ) );
+   sort( sorted_itemsets.begin(), sorted_itemsets.end(), itemset_less<ITEM> );
+   for( unsigned long itemset_index = 0; itemset_index < sorted_itemsets.size(); itemset_index++ )
+   {
+      STATE state = 0;
+      for( const ITEM* it_item = sorted_itemsets[itemset_index].first; it_item != sorted_itemsets[itemset_index].second; it_item++ )
+      {
+         STATE next_state = child( state, *it_item );
+         if( !next_state )
+         {
+            add_empty_state( state, *it_item );
+            next_state = itemarray.size()-1;
+         }
+         state = next_state;
+      }
+      max_path_set( parent[state] );
+   }
+}
+
+/**
+  The first level is counted by the first scan, the node of item i is node i, so the larger itemsets are the nodes from
+  itemarray[0].size()+1 on. Their counters are cleared, the ones of size more than two are counted by a frozen image
+  whose counted nodes start at depth three.
+  \param count_pairs If true, every pair of frequent items gets a counter.
+*/
+template <class ITEM, class STATE, class COUNTER>
+ITEM Trie<ITEM,STATE,COUNTER>::prepare_verification( const bool count_pairs )
+{
+   const STATE first_pair = itemarray[0].size()+1;
+   for( STATE stateIndex = first_pair; stateIndex < itemarray.size(); stateIndex++ ) countervector[stateIndex] = 0;
+   first_candidate = first_pair;
+   if( count_pairs && itemarray[0].size() > 1 )
+   {
+      vector<unsigned long> supports( countervector.begin(), countervector.begin()+first_pair );
+      temp_counter_array->init( itemarray[0].size(), supports, countervector[0] );
+   }
+   if( maxpath[0] > 2 )
+   {
+      choose_representation( maxpath[0] );
+      freeze( maxpath[0], 3 );
+   }
+   return maxpath[0];
+}
+
+/**
+  \param min_occurrence The threshold of absolute support.
+  \param restart If true, the larger itemsets are deleted even if every frequent pair is in the trie.
+*/
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie<ITEM,STATE,COUNTER>::finish_verification( const unsigned long min_occurrence, const bool restart )
+{
+   const STATE   first_pair = itemarray[0].size()+1;
+   unsigned long missed_pairs = 0;
+   thaw();
+   if( itemarray[0].size() > 1 )
+   {
+      vector<itemtype>      first_items,
+                            second_items;
+      vector<unsigned long> counters;
+      vector<ITEM>          items;
+      vector<STATE>         states;
+      temp_counter_array->frequent_pairs( min_occurrence, first_items, second_items, counters );
+      missed_pairs = counters.size();
+      for( STATE item_state = 1; item_state < first_pair; item_state++ )
+      {
+         get_children( item_state, items, states );
+         for( unsigned long edge_index = 0; edge_index < states.size(); edge_index++ )
+         {
+            countervector[states[edge_index]] = temp_counter_array->get( item_state, items[edge_index] );
+            if( countervector[states[edge_index]] >= min_occurrence ) missed_pairs--;
+         }
+      }
+   }
+   if( restart || missed_pairs )
+   {
+      for( STATE stateIndex = first_pair; stateIndex < itemarray.size(); stateIndex++ ) countervector[stateIndex] = 0;
+      delete_infrequent_more( 1 );
+      if( itemarray[0].size() > 1 )
+      {
+         maxpath[0] = 2;
+         delete_infrequent_two( min_occurrence );
+      }
+   }
+   else
+   {
+      delete_infrequent_more( min_occurrence );
+      temp_counter_array->clear();
+   }
+   return missed_pairs;
+}
+
+/**
+  \param min_occurrence The threshold of absolute support.
+*/
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie<ITEM,STATE,COUNTER>::frequent_leaves( const unsigned long min_occurrence )
+{
+   unsigned long frequent = 0;
+   thaw();
+   for( STATE stateIndex = itemarray[0].size()+1; stateIndex < itemarray.size(); stateIndex++ )
+      if( itemarray[stateIndex].empty() && countervector[stateIndex] >= min_occurrence ) frequent++;
+   return frequent;
+}
+
+/**
+  With more threads the subtrees of the root are processed in batches. The threads of a batch take the subtrees from a common queue,
+  and the rules of the batch are written in the order of the subtrees, so the output does not depend on the number of threads.
   \param outcomefile The file the output will be written to.
   \param min_conf Confidence threshold.
+  \param min_lift Lift threshold (0 if there is none).
+  \param threads The number of threads.
+  \param min_occurrence The rules of the itemsets that occur less times are left out.
 */
-void Trie::association( ofstream& outcomefile, const double min_conf ) const
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::association( ofstream& outcomefile, const double min_conf, const double min_lift, const unsigned threads,
+                                            const unsigned long min_occurrence ) const
 {
    outcomefile << "\nAssociation rules:\ncondition ==> consequence (confidence, occurrence)\n";
-   set<itemtype> consequence_part;
-   assoc_rule_assist( outcomefile, min_conf, 0, consequence_part );
+   if( threads > 1 )
+   {
+      vector<ITEM>  root_items;
+      vector<STATE> root_states;
+      get_children( 0, root_items, root_states );
+      for( unsigned long task_begin = 0; task_begin < root_states.size(); task_begin += threads*rule_tasks_per_thread )
+      {
+         const unsigned long      task_end = min( task_begin+threads*rule_tasks_per_thread, (unsigned long) root_states.size() );
+         vector<string>           rules( task_end-task_begin );
+         vector<thread>           thread_pool;
+         atomic<unsigned long>    next_task( task_begin );
+         for( unsigned thread_index = 0; thread_index < threads; thread_index++ )
+            thread_pool.push_back( thread( &Trie::assoc_rule_thread, this, &root_items, &root_states, task_end,
+                                           &next_task, &rules, min_conf, min_lift, min_occurrence ) );
+         for( unsigned thread_index = 0; thread_index < threads; thread_index++ ) thread_pool[thread_index].join();
+         for( unsigned long rule_index = 0; rule_index < rules.size(); rule_index++ )
+            outcomefile.write( rules[rule_index].data(), rules[rule_index].size() );
+      }
+   }
+   else
+   {
+      Rule_work work( maxpath[0] );
+      work.outcomefile = &outcomefile;
+      assoc_rule_assist( work, 0, 0, min_conf, min_lift, min_occurrence );
+      outcomefile.write( work.rules.data(), work.rules.size() );
+   }
+   outcomefile.flush();
 }
 /**
-  \param basket The given basket.
+  Infrequent items are dropped.
+  \param basket The given basket. Its items have to be distinct (Input_data::read_in_a_line guarantees this).
+  \param recoded_basket The codes of the frequent items of the basket in increasing order.
 */
-void Trie::basket_recode( vector<itemtype>& basket ) const
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::basket_recode( const vector<itemtype>& basket, vector<ITEM>& recoded_basket ) const
 {
-   set<itemtype> tempset;
-   for( vector<itemtype>::iterator it_basket = basket.begin(); it_basket != basket.end(); it_basket++ )
-     if( inv_orderarray[*it_basket+1] ) tempset.insert( inv_orderarray[*it_basket+1] );
-   basket.clear();
-   basket.insert( basket.end(), tempset.begin(), tempset.end() );
+   recoded_basket.clear();
+   for( vector<itemtype>::const_iterator it_basket = basket.begin(); it_basket != basket.end(); it_basket++ )
+     if( *it_basket+1 < inv_orderarray.size() && inv_orderarray[*it_basket+1] ) recoded_basket.push_back( inv_orderarray[*it_basket+1] );
+   sort( recoded_basket.begin(), recoded_basket.end() );
 }
 
-unsigned long Trie::node_number() const
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie<ITEM,STATE,COUNTER>::node_number() const
 {
    if( maxpath[0] == 2 && itemarray[0].size()+1 == itemarray.size() )
       return itemarray.size()+(itemarray.size()-1)*(itemarray.size()-2)/2;
    else return itemarray.size();
 }
-void Trie::statistics() const
+/**
+  The vectors are counted by their capacity and the size of their elements,
+  the edge vectors of the nodes by their headers too.
+*/
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie<ITEM,STATE,COUNTER>::memory() const
 {
-   unsigned long mem = itemarray.capacity()+statearray.capacity()+
-         countervector.capacity()+maxpath.capacity()+parent.capacity();
+   unsigned long mem = itemarray.capacity()*sizeof(vector<ITEM>) + statearray.capacity()*sizeof(vector<STATE>) +
+                       countervector.capacity()*sizeof(COUNTER) + maxpath.capacity()*sizeof(ITEM) +
+                       parent.capacity()*sizeof(STATE) + orderarray.capacity()*sizeof(itemtype) +
+                       inv_orderarray.capacity()*sizeof(ITEM) +
+                       (frozen.arena.capacity()+frozen.level_begin.capacity())*sizeof(unsigned long);
 
+   for( STATE stateIndex = 0; stateIndex < itemarray.size(); stateIndex++)
+      mem += itemarray[stateIndex].capacity()*sizeof(ITEM) + statearray[stateIndex].capacity()*sizeof(STATE);
+   return mem + temp_counter_array->memory();
+}
 
-   for( unsigned long stateIndex = 0; stateIndex < itemarray.size(); stateIndex++)
-      mem += itemarray[stateIndex].capacity() + statearray[stateIndex].capacity();
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::statistics() const
+{
+   const unsigned long mem = memory();
 //   cout<<"\nThe number of nodes of the trie: "<<itemarray.size();
    if( maxpath[0] == 2 && itemarray[0].size()+1 == itemarray.size())
-      mem += (itemarray.size()-1)*(itemarray.size()-2)*sizeof(long)/2 + (itemarray.size()-1)*sizeof(unsigned long*);
+   {
+      cout << "The itempair counters are stored in a " << (temp_counter_array->is_dense() ? "triangular array." : "hash table.") << endl;
+   }
    cout << "The memory need is: ";
    if( mem/1048576 ) cout << mem/1048576 << " Mbyte + ";
    if( (mem%1048576)/1024 ) cout << (mem%1048576)/1024<<" Kbyte + ";
    cout << mem%1024 <<" byte" << endl;
 }
-void Trie::write_content_to_file( ofstream& outcomefile ) const
+/**
+  The itemsets of all sizes are given to the writer by a single depth-first traversal, the writer groups them by size.
+  \param writer The writer of the outcome file.
+  \param min_occurrence The itemsets that occur less times are left out (the ones of the last threshold if it was raised during the mining).
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::write_content_to_file( Result_writer& writer, const unsigned long min_occurrence ) const
 {
-   outcomefile << "Frequent 0-itemsets:\nitemset (occurrence)\n";
-   outcomefile << "{} ("<< countervector[0] << ')' << endl;
-   for( itemtype item_size = 1; item_size < maxpath[0]+1; item_size++ )
-   {
-      outcomefile << "Frequent " << item_size << "-itemsets:\nitemset (occurrence)\n";
-      set<itemtype> frequent_itemset;
-      write_content_to_file_assist( outcomefile, 0, item_size, 0, frequent_itemset );
-   }
+   vector<itemtype> frequent_itemset( maxpath[0]+1 );
+   write_content_to_file_assist( writer, 0, 0, frequent_itemset.data(), min_occurrence );
 }
 
-void Trie::show_content() const
+template <class ITEM, class STATE, class COUNTER>
+void Trie<ITEM,STATE,COUNTER>::show_content() const
 {
-   unsigned long stateIndex;
-   itemtype      edgeIndex;
+   STATE         stateIndex;
+   ITEM          edgeIndex;
    cout<< "\nSize:" << itemarray.size();
    for( stateIndex = 0; stateIndex < itemarray.size(); stateIndex++)
    {
       cout << endl << "Size of the " << stateIndex << "th state:" << itemarray[stateIndex].size()
       << " its counter: " << countervector[stateIndex] << " longest path: "
       << maxpath[stateIndex] << ", edge point to it: " << parent[stateIndex]<<",leafs:";
-      vector<unsigned long>::const_iterator it_state = statearray[stateIndex].begin();
-      for( vector<itemtype>::const_iterator it_item = itemarray[stateIndex].begin(); it_item != itemarray[stateIndex].end(); it_item++, it_state++ )
+      typename vector<STATE>::const_iterator it_state = statearray[stateIndex].begin();
+      for( typename vector<ITEM>::const_iterator it_item = itemarray[stateIndex].begin(); it_item != itemarray[stateIndex].end(); it_item++, it_state++ )
          cout << endl << "Item " << *it_item << " leads to state " << *it_state;
    }
-   if( maxpath[0] == 1 && itemarray[0][0] < itemarray.size() )
+   if( maxpath[0] == 2 && itemarray[0].size()+1 == itemarray.size() )
    {
       cout << endl << "Content of 2D table (counters of itempairs)";
-      for( stateIndex = 0; stateIndex < itemarray[0].size()-1; stateIndex++ )
+      for( stateIndex = 1; stateIndex < itemarray[0].size(); stateIndex++ )
          {
             cout << endl;
-            for( edgeIndex =0 ; edgeIndex < itemarray[0].size()-1-stateIndex; edgeIndex++)
-               cout << temp_counter_array[stateIndex][edgeIndex]<< ',';
+            for( edgeIndex = stateIndex+1 ; edgeIndex <= itemarray[0].size(); edgeIndex++)
+               cout << temp_counter_array->get( stateIndex, edgeIndex )<< ',';
          }
    }
 }
-Trie::~Trie()
+template <class ITEM, class STATE, class COUNTER>
+Trie<ITEM,STATE,COUNTER>::~Trie()
 {
+   delete temp_counter_array;
 }
+
+template class Trie<unsigned short, unsigned int, unsigned int>;
+template class Trie<unsigned short, unsigned int, unsigned long>;
+template class Trie<unsigned int, unsigned int, unsigned int>;
+template class Trie<unsigned int, unsigned int, unsigned long>;
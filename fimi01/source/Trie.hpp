@@ -13,54 +13,235 @@
   *@author Ferenc Bodon
   */
 
+/// The type of the items of the basket file (before recoding).
 typedef unsigned long itemtype;
-//typedef unsigned short itemtype;
 
 #include <fstream>
 #include <iostream>
 #include <set>
 #include <vector>
 #include <cstdio>
+#include <limits>
+#include <atomic>
+#include <string>
+#include <algorithm>
+#include <functional>
 using namespace std;
 
+class Pair_counter;
+class Result_writer;
+template <class ITEM, class COUNTER> class Basket_tree;
+
+/** Adds a support to a heap of the k largest supports.
+  *
+  * heap is a min-heap (its front is the k<sup>th</sup> largest support once it has k elements).
+  */
+inline void add_top_support( vector<unsigned long>& heap, const unsigned long k, const unsigned long support )
+{
+   if( heap.size() < k )
+   {
+      heap.push_back( support );
+      push_heap( heap.begin(), heap.end(), greater<unsigned long>() );
+   }
+   else if( support > heap.front() )
+   {
+      pop_heap( heap.begin(), heap.end(), greater<unsigned long>() );
+      heap.back() = support;
+      push_heap( heap.begin(), heap.end(), greater<unsigned long>() );
+   }
+}
+
+/** Counting_context tells a support counting walk where to add the occurrences of the candidates.
+
+   The default context adds to the countervector of the trie.
+   Threads that count the same trie in parallel use their own counter arrays (which are summed up by Trie::add_counters),
+   or share one array and add atomically when private arrays would need too much memory.
+   Every context also measures the lookups of the walk (they are summed up by Trie::add_lookups).
+   If hits is given, the walk also counts for every item of the basket the candidates that contain it.
+*/
+template <class COUNTER> struct Counting_context
+{
+   Counting_context( COUNTER* counters_in=0, const bool atomic_in=false, const unsigned long depth_number=0 ):
+      counters(counters_in),atomic(atomic_in),hits(0),visits(depth_number,0),items(depth_number,0) {}
+
+   /// Increases the counter of the given state.
+   void add( const unsigned long state, const COUNTER counter )
+   {
+      if( atomic ) __atomic_fetch_add( counters+state, counter, __ATOMIC_RELAXED );
+      else counters[state] += counter;
+   }
+
+   /// counters[i] is increased when the i<sup>th</sup> candidate of the frozen trie is found.
+   COUNTER*       counters;
+
+   /// If true, counters is shared between threads.
+   bool           atomic;
+
+   /** If not 0, hits[j] is increased by the number of found candidates that contain the j<sup>th</sup> item
+     * from the end of the basket (hits[0] belongs to the last item).
+     */
+   unsigned long* hits;
+
+   /// visits[d] is the number of times the walk reached a node at depth d.
+   vector<unsigned long> visits;
+
+   /// items[d] is the number of basket items that were left when the walk reached an inner node at depth d.
+   vector<unsigned long> items;
+
+   /// The walk on a basket tree keeps the children of the actual node at depth d in children[d*(item number+1)+item].
+   vector<unsigned long> children;
+};
+
 /** Trie (or prefix-tree) is a tree-based datastructure.
 
    Trie is a rooted directed tree. The root is defined to be at depth 0, and a node at depth <em>d</em> can point to nodes at depth <em>d+1</em>.
    A pointer is also called edge or link, which is labeled by an item.
    If node <em>u</em> points to node <em>v</em>, then we call <em>u</em> the parent of <em>v</em>, and <em>v</em> is a child node of <em>u</em>.
 
+   The trie is parameterized by the types of the item codes (ITEM), of the node indices (STATE) and of the counters (COUNTER).
+   Frequent items and nodes usually fit in 16 and 32 bits, so the narrowest types that fit halve the memory
+   and the bandwidth of the trie compared with unsigned long; Apriori_driver chooses them after the first scan.
+   The member functions are instantiated in Trie.cpp for the supported combinations.
 */
 
-class Trie
+template <class ITEM, class STATE, class COUNTER> class Trie
 {
 
 public:
 
    Trie();
 
-   /// Generates candidates.
-   void candidate_generation( const itemtype& frequent_size );
+   /// Builds the first level of the trie from the occurrences of the items (the first scan is done by Apriori_driver).
+   virtual void set_first_level( const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                                 const unsigned long min_occurrence );
+
+   /// Generates candidates (the subtrees of the root are processed by the given number of threads).
+   void candidate_generation( const ITEM& frequent_size, const unsigned threads = 1, const bool bundled = false );
 
-   /// Increases the counter of those candidates that are contained by the given basket.
-   void find_candidate( const vector<itemtype>& basket, const itemtype candidate_size, const unsigned long counter=1 );
+   /// Returns an upper bound of the number of the (candidate_size+1)-itemset candidates that the candidates of the given size generate.
+   unsigned long candidate_bound( const ITEM candidate_size ) const;
 
-   /// Deletes unfrequent itemsets.
-   void delete_infrequent( const unsigned long min_occurrence );
+   /// Returns the number of bytes a candidate occupies in the trie and in the frozen image (without hash nodes and bitmap indices).
+   static unsigned long candidate_memory()
+   {
+      return 2*sizeof(vector<ITEM>) + 2*sizeof(ITEM) + 4*sizeof(STATE) + 2*sizeof(COUNTER) + sizeof(unsigned long);
+   }
 
-   /// Generates association rules
-   void association( ofstream& outcomefile, const double min_conf ) const;
+   /** Increases the counter of those candidates that are contained by the given basket (candidate_size>1).
+     *
+     * Returns the number of candidates found in the basket (0 for candidate_size=2).
+     */
+   unsigned long find_candidate( const ITEM* basket_begin, const ITEM* basket_end, const ITEM candidate_size,
+                                 const COUNTER counter=1 );
+
+   /// Increases the counter of those candidates that are contained by the given basket (candidate_size>1).
+   void find_candidate( const vector<ITEM>& basket, const ITEM candidate_size, const COUNTER counter=1 )
+   {
+      find_candidate( basket.data(), basket.data()+basket.size(), candidate_size, counter );
+   }
+
+   /** Increases the counters of the context for those candidates that are contained by the given basket (candidate_size>2).
+     *
+     * Returns the number of candidates found in the basket.
+     */
+   unsigned long find_candidate( const ITEM* basket_begin, const ITEM* basket_end, const ITEM candidate_size,
+                                 const COUNTER counter, Counting_context<COUNTER>& context ) const
+   {
+      return find_candidate_more( basket_begin, basket_end, candidate_size, 0, 0, counter, context );
+   }
+
+   /// Increases the counter of those candidates that are contained by the baskets of the subtrees node_begin ... node_end-1 of a basket tree (candidate_size>2).
+   void find_candidate( const Basket_tree<ITEM,COUNTER>& tree, const unsigned long node_begin, const unsigned long node_end,
+                        const ITEM candidate_size )
+   {
+      find_candidate( tree, node_begin, node_end, candidate_size, frozen.context );
+   }
+
+   /// Increases the counters of the context for those candidates that are contained by the baskets of the given subtrees of a basket tree.
+   void find_candidate( const Basket_tree<ITEM,COUNTER>& tree, const unsigned long node_begin, const unsigned long node_end,
+                        const ITEM candidate_size, Counting_context<COUNTER>& context ) const
+   {
+      if( context.children.size() < (unsigned long) candidate_size*(itemarray[0].size()+1) )
+         context.children.assign( (unsigned long) candidate_size*(itemarray[0].size()+1), 0 );
+      find_candidate_tree( tree, node_begin, node_end, candidate_size, 0, 0, context );
+   }
+
+   /// Returns the number of counters of the frozen trie (the number of candidates).
+   unsigned long counter_number() const {return frozen.node_number-frozen.first_counted;}
+
+   /// Returns a context that adds to the given counters (to the counters of the frozen trie by default).
+   Counting_context<COUNTER> counting_context( const bool atomic=false, COUNTER* counters=0 ) const
+   {
+      return Counting_context<COUNTER>( counters ? counters : frozen.counters, atomic, frozen.level_begin.size()-1 );
+   }
+
+   /// Adds the given counters (collected by a separate context) to the counters of the trie.
+   void add_counters( const vector<COUNTER>& counters );
+
+   /// Adds the lookups measured by a separate context to the lookup profile of the trie.
+   void add_lookups( const Counting_context<COUNTER>& context );
+
+   /** Appends the counters of the candidates to the given vector (after the support counting, before delete_infrequent).
+     *
+     * The counters of the larger candidates are given in the order of their states, so they do not depend on the frozen image:
+     * tries that contain the same itemsets can add up their counters by set_counters.
+     */
+   void get_counters( vector<unsigned long>& counters ) const;
 
-   /// Recodes the basket so that each item is substituted by its s frequency order (inv_orderarray[]).
-   void basket_recode( vector<itemtype>& basket ) const;
+   /// Adds the counters of get_counters to the counters of the candidates (or replaces them if add is false).
+   void set_counters( const vector<unsigned long>& counters, const bool add );
+
+   /// Adds the supports of the counted candidates that are at least min_occurrence to the heap of the k largest supports (see add_top_support).
+   void top_supports( const unsigned long min_occurrence, const unsigned long k, vector<unsigned long>& heap ) const;
+
+   /** Deletes unfrequent itemsets.
+     *
+     * If border is given, the infrequent candidates of size more than two whose parent is frequent are appended to it
+     * (the size of the itemset followed by its items), so it collects the negative border of the frequent itemsets.
+     */
+   void delete_infrequent( const unsigned long min_occurrence, vector<ITEM>* border = 0 );
+
+   /// Adds the itemsets of size more than one (in the format of the border of delete_infrequent) to a trie that has only its first level.
+   void add_itemsets( const vector<ITEM>& itemsets );
+
+   /// Appends the itemsets of size more than one to the given vector (in the format of add_itemsets), returns their number.
+   unsigned long get_itemsets( vector<ITEM>& itemsets ) const;
+
+   /** Prepares the counting of every itemset of size more than one in one scan, returns the size of the largest itemsets.
+     *
+     * The itemsets of size more than two are counted by the frozen image, the pairs (if count_pairs is true) by the pair counters,
+     * so the scan calls find_candidate with the returned size and with 2.
+     */
+   ITEM prepare_verification( const bool count_pairs );
+
+   /** Finishes the counting of prepare_verification(true), returns the number of frequent pairs that are not in the trie.
+     *
+     * If it is 0 and restart is false, the infrequent itemsets are deleted.
+     * Otherwise only the first level and the frequent pairs are kept, so the larger itemsets can be mined again.
+     */
+   unsigned long finish_verification( const unsigned long min_occurrence, const bool restart );
+
+   /// Finishes the counting of prepare_verification(false), returns the number of leaves of size more than one that are frequent.
+   unsigned long frequent_leaves( const unsigned long min_occurrence );
+
+   /// Generates association rules (the frequent itemsets are processed by the given number of threads).
+   void association( ofstream& outcomefile, const double min_conf, const double min_lift = 0, const unsigned threads = 1,
+                     const unsigned long min_occurrence = 0 ) const;
+
+   /// Recodes the basket so that each item is substituted by its frequency order (inv_orderarray[]).
+   void basket_recode( const vector<itemtype>& basket, vector<ITEM>& recoded_basket ) const;
 
    /// Returns the number of nodes in the trie
    unsigned long node_number() const;
 
+   /// Returns the number of bytes the trie occupies (with the frozen image and the pair counters).
+   virtual unsigned long memory() const;
+
    /// Displays the memory need of the trie
    virtual void statistics() const;
 
-   /// Writes the content (frequent itemsets) to the file
-   void write_content_to_file( ofstream& outcomefile ) const;
+   /// Writes the content (frequent itemsets) to the file, the itemsets that occur less than min_occurrence times are left out.
+   void write_content_to_file( Result_writer& writer, const unsigned long min_occurrence = 0 ) const;
 
    /// Displays the trie
    virtual void show_content() const;
@@ -69,41 +250,116 @@ public:
 
 protected:
 
+   /** The candidates collected under some nodes of the trie before they are added to it.
+     *
+     * leaves are the nodes at depth frequent_size-1 that have children, in depth-first order.
+     * The children of leaves[i] are extended[leaf_ends[i-1]] ... extended[leaf_ends[i]-1], and
+     * the new children of extended[j] are labeled by items[item_ends[j-1]] ... items[item_ends[j]-1].
+     */
+   struct Candidate_buffer
+   {
+      vector<STATE>         leaves;
+      vector<unsigned long> leaf_ends;
+      vector<STATE>         extended;
+      vector<unsigned long> item_ends;
+      vector<ITEM>          items;
+
+      void clear() {leaves.clear(); leaf_ends.clear(); extended.clear(); item_ends.clear(); items.clear();}
+   };
+
+   /// The work space of a depth-first collection of candidates, every array has an entry for each depth.
+   struct Generation_work
+   {
+      Generation_work( const ITEM frequent_size ):maybe_candidate(frequent_size),path(frequent_size,0),subset_states(frequent_size),
+                                                   child_items(frequent_size),child_states(frequent_size) {}
+
+      /// The items of the actual path.
+      vector<ITEM>            maybe_candidate;
+      /// path[i] is the node that represents the first i items of the actual path.
+      vector<STATE>           path;
+      /// The states of the subsets of the candidates that leave out a prefix item.
+      vector<STATE>           subset_states;
+      /// The children of the nodes of the actual path.
+      vector< vector<ITEM> >  child_items;
+      vector< vector<STATE> > child_states;
+   };
+
+   /// The work space of a thread that generates association rules, every array has an entry for each depth.
+   struct Rule_work
+   {
+      Rule_work( const ITEM max_size ):itemset(max_size),path(max_size+1,0),in_condition(max_size,false),
+                                       child_items(max_size+1),child_states(max_size+1),outcomefile(0) {}
+
+      /// The items of the actual frequent itemset.
+      vector<ITEM>            itemset;
+      /// path[i] is the node that represents the first i items of the actual itemset.
+      vector<STATE>           path;
+      /// in_condition[i] is true if the i<sup>th</sup> item of the itemset belongs to the condition of the actual rule.
+      vector<char>            in_condition;
+      vector< vector<ITEM> >  child_items;
+      vector< vector<STATE> > child_states;
+      /// The rules in the format of the outcome file.
+      string                  rules;
+      /// If it is not 0, rules is written to this file whenever it grows too large.
+      ofstream*               outcomefile;
+   };
+
    /// Sets the maximal path value.
-   virtual void max_path_set( const unsigned long state_index );
+   virtual void max_path_set( const STATE state_index );
+
+   /// Builds the frozen image that the support counting of the candidates of the given size uses.
+   void freeze( const ITEM candidate_size, const ITEM counted_size );
+
+   /// Adds the counters of the frozen image to countervector and releases the image.
+   void thaw();
+
+   /// Returns the children of a state in increasing order of their labels.
+   virtual void get_children( const STATE state_index, vector<ITEM>& items, vector<STATE>& states ) const;
+
+   /// Returns the number of children of a state.
+   virtual ITEM child_number( const STATE state_index ) const {return itemarray[state_index].size();}
+
+   /// Returns the number of items the bitmap index of a state covers in the frozen image, 0 for a sorted edge list.
+   virtual ITEM bitmap_size( const STATE state_index ) const {return 0;}
+
+   /// Chooses the representation of the nodes in the frozen image of the candidates of the given size (called before freeze).
+   virtual void choose_representation( const ITEM candidate_size ) {}
 
    /// Deletes the edge that goes to a given state.
-   virtual void delete_edge( const unsigned long from_state, const unsigned long to_state );
+   virtual void delete_edge( const STATE from_state, const STATE to_state );
 
    /// Adds an empty state to the trie
-   virtual void add_empty_state( const unsigned long from_state, const itemtype item, const unsigned long counter=0 );
-
-   /// It decides whether the given itemset is included in the trie or not.
-   virtual unsigned long is_included( const set<itemtype>& an_itemset ) const;
+   virtual void add_empty_state( const STATE from_state, const ITEM item, const COUNTER counter=0 );
 
-   /// Decides if all subset of of an itemset is contained in the trie
-   bool is_all_subset_frequent( const set<itemtype>& maybe_candidate ) const;
+   /// Returns the child of the state that the edge labeled by item leads to, 0 if there is no such edge.
+   virtual STATE child( const STATE state_index, const ITEM item ) const;
 
    /// Generates candidate of size two
    void candidate_generation_two();
 
-   /// Generates candidate of size more than two
-   virtual void candidate_generation_assist( unsigned long actual_state, const itemtype frequent_size,
-                                             const itemtype actual_sizet, set<itemtype>& maybe_candidate );
+   /// Collects the candidates of size more than two under a node, the trie is not modified.
+   void collect_candidates( const STATE actual_state, const ITEM frequent_size, const ITEM actual_size,
+                            Generation_work& work, Candidate_buffer& buffer ) const;
 
-   /// Increases the counter for those items that are in the given basket.
-   void find_candidate_one( const vector<itemtype>& basket );
+   /// Collects the candidates of the subtrees of the root that are taken from a common queue.
+   void collect_thread( const ITEM frequent_size, const vector<ITEM>* root_items, const vector<STATE>* root_states,
+                        const vector<ITEM>* queue, atomic<unsigned long>* next_task, vector<Candidate_buffer>* buffers ) const;
+
+   /// Adds the collected candidates to the trie.
+   virtual void splice_candidates( const Candidate_buffer& buffer );
 
    /// Increases the counter for those itempairs that are in the given basket.
-   void find_candidate_two( const vector<itemtype>& basket, const unsigned long counter=1 );
+   void find_candidate_two( const ITEM* basket_begin, const ITEM* basket_end, const COUNTER counter=1 );
 
-   /// Increases the counter for those itemsets that is contained by the given basket.
-   virtual void find_candidate_more( const vector<itemtype>& basket, const itemtype candidate_size,
-                                     vector<itemtype>::const_iterator it_basket, const unsigned long actual_state,
-                                     const itemtype actual_size, const unsigned long counter=1 );
+   /// Increases the counter for those itemsets that is contained by the given basket (walks the frozen image), returns their number.
+   unsigned long find_candidate_more( const ITEM* it_basket, const ITEM* basket_end, const ITEM candidate_size,
+                                      const STATE actual_state, const ITEM actual_size, const COUNTER counter,
+                                      Counting_context<COUNTER>& context ) const;
 
-   /// Deletes the nodes that represent infrequent itemsets of size 1.
-   virtual void delete_infrequent_one( const unsigned long min_occurrence );
+   /// Increases the counter for those itemsets that are contained by the baskets of the given subtrees (walks the frozen image).
+   void find_candidate_tree( const Basket_tree<ITEM,COUNTER>& tree, const unsigned long node_begin, const unsigned long node_end,
+                             const ITEM candidate_size, const STATE actual_state, const ITEM actual_size,
+                             Counting_context<COUNTER>& context ) const;
 
    /// Deletes the nodes that represent infrequent itemsets of size 2.
    virtual void delete_infrequent_two( const unsigned long min_occurrence );
@@ -111,15 +367,25 @@ protected:
    //! Deletes the nodes that represent infrequent itemsets.
    virtual void delete_infrequent_more( const unsigned long min_occurrence );
 
-   void assoc_rule_find( ofstream& outcomefile, const double min_conf, set<itemtype>& condition_part,
-                         set<itemtype>& consequence_part, const unsigned long union_support) const;
+   /// Generates the rules of the actual itemset whose condition is the given one extended by items from first_position on.
+   void assoc_rule_find( Rule_work& work, const ITEM itemset_size, const ITEM first_position, const STATE condition_state,
+                         const ITEM condition_size, const double min_conf, const double min_lift ) const;
+
+   /// Generates the rules of the itemsets of the subtrie of a state.
+   void assoc_rule_assist( Rule_work& work, const STATE actual_state, const ITEM actual_size,
+                           const double min_conf, const double min_lift, const unsigned long min_occurrence ) const;
 
-   virtual void assoc_rule_assist( ofstream& outcomefile, const double min_conf,unsigned long actual_state,
-                                   set<itemtype>& consequence_part) const;
+   /// Generates the rules of the subtrees of the root that are taken from a common queue.
+   void assoc_rule_thread( const vector<ITEM>* root_items, const vector<STATE>* root_states, const unsigned long task_end,
+                           atomic<unsigned long>* next_task, vector<string>* rules, const double min_conf, const double min_lift,
+                           const unsigned long min_occurrence ) const;
 
-   //! Writes out the content of the trie (frequent itemset and counters).
-   virtual void write_content_to_file_assist( ofstream& outcomefile, const unsigned long actual_state, const itemtype item_size,
-                                              const itemtype actual_size,set<itemtype>& frequent_itemset) const;
+   //! Writes out the content of the subtrie of a state (frequent itemset and counters).
+   virtual void write_content_to_file_assist( Result_writer& writer, const STATE actual_state, const ITEM actual_size,
+                                              itemtype* frequent_itemset, const unsigned long min_occurrence ) const;
+
+   /// Appends the itemset of the given state to the given vector (its size followed by its items).
+   void append_itemset( const STATE state, vector<ITEM>& itemsets ) const;
 private:
    // No private methods
 
@@ -133,43 +399,137 @@ protected:
      * itemarray[i][j] stores the label of the j<sup>th</sup> edge (of the i<sup>th</sup> node).
      * A label is a positive integer number (the code of an item).
      */
-   vector< vector<itemtype> > itemarray;
+   vector< vector<ITEM> > itemarray;
 
    /**  stetearray stores the end node of the edges.
      *
      * statearray[i] belongs to the i<sup>th</sup> node.
      * statearray[i][j] stores the end node of the j<sup>th</sup> edge (of the i<sup>th</sup> node).
      */
-   vector< vector<unsigned long> > statearray;
+   vector< vector<STATE> > statearray;
 
    /**  countervector stores the occurences of the itemsets
      *
      * countervector[i] stores the occurence of the itemset represented by the i<sup>th</sup> node.
      */
-    vector<unsigned long> countervector;
+    vector<COUNTER> countervector;
+
+    vector<STATE> parent;
 
-    vector<unsigned long> parent;
+   /** The first state of the candidates that are counted by the actual scan.
+     *
+     * The candidates are added after the frequent itemsets, the states before first_candidate are never deleted
+     * (they are frequent even if the threshold is raised meanwhile).
+     */
+   STATE first_candidate;
 
    /**  temp_counter_array stores the occurences of the itempairs
      *
-     * countervector[i][j] stores the occurence of the itempair (orderarray[i],orderarray[j]).
+     * temp_counter_array->get(i,j) is the occurence of the itempair (orderarray[i],orderarray[j]).
      */
-   vector< vector<unsigned long> > temp_counter_array;
+   Pair_counter* temp_counter_array;
 
    /**  maxpath stores the legth of the longest paths.
      *
      * maxpath[i] stores the legth of the longest path starting from the i<sup>th</sup> node.
      */
-  vector<itemtype> maxpath;
+  vector<ITEM> maxpath;
 
   /**  The frequency order of the items
     *
-    * orderarray[1] is the most frequent item, orderarray[2] is the second most frequent...
+    * orderarray[1] is the least frequent item, orderarray[2] is the second least frequent...
+    * (orderarray[i] is the item increased by one.)
     */
   vector<itemtype> orderarray;
 
   ///  inverse of orderarray: orderarray[inv_orderarray[i]]=i
-  vector<itemtype> inv_orderarray;
+  vector<ITEM> inv_orderarray;
+
+  /** The frozen image of the trie that the support counting of the candidates of size more than two walks.
+    *
+    * When candidate_generation has finished, the nodes that lie on a path to a candidate are copied in BFS order into a single arena.
+    * Node i of the image has the edges edge_begin[i] ... edge_begin[i+1]-1, the label of an edge is in edge_item and its end node
+    * (an index of the image) is in edge_child. The edges of a node marked by bitmap_flag start with a bitmap index of bitmap_words words
+    * in edge_child, and the children follow it in the order of their labels.
+    * Edges whose end node has too short maxpath are left out, so the counting does not need maxpath at all.
+    * The candidates are the last nodes of the BFS order; their counters are collected in counters and are added to countervector by thaw.
+    * The arrays are typed sections of the arena, each of them aligned to sizeof(unsigned long).
+    */
+  struct Frozen_trie
+  {
+     Frozen_trie():edge_begin(0),edge_item(0),edge_child(0),state(0),counters(0),node_number(0),first_counted(0),counted_size(0),
+                   bitmap_words(0),level_begin(1,0) {}
+
+     vector<unsigned long> arena;
+     unsigned long*        edge_begin;
+     ITEM*                 edge_item;
+     STATE*                edge_child;
+     /// state[i] is the node of the trie that is represented by the i<sup>th</sup> node of the image.
+     STATE*                state;
+     /// counters[i] stores the occurrence of the candidate represented by node first_counted+i of the image.
+     COUNTER*              counters;
+     unsigned long         node_number;
+     unsigned long         first_counted;
+     /// The nodes at depth counted_size and below are counted (more than one level if the levels are bundled).
+     unsigned long         counted_size;
+     /// The size of the bitmap indices of the image (every bitmap index covers the same items).
+     unsigned long         bitmap_words;
+     /// The nodes at depth d are level_begin[d] ... level_begin[d+1]-1 in the image.
+     vector<unsigned long> level_begin;
+     /// The context of the counting that goes through find_candidate.
+     Counting_context<COUNTER> context;
+  } frozen;
+
+  /** The lookups of the last support counting that used the frozen image.
+    *
+    * visits and items are summed from the counting contexts (see Counting_context),
+    * supports[d] is the sum of the counters of the image nodes at depth d (the candidates included).
+    * Their ratio tells how many times a node is reached compared with its occurrence,
+    * which depends on the number of distinct baskets and on the nodes that are left out from the image.
+    */
+  struct Lookup_profile
+  {
+     vector<unsigned long> visits,
+                           items,
+                           supports;
+  } profile;
+
+  /// Returns the number of arena words that element_number elements of type T occupy.
+  template <class T> static unsigned long arena_words( const unsigned long element_number )
+  {
+     return (element_number*sizeof(T)+sizeof(unsigned long)-1)/sizeof(unsigned long);
+  }
+
+  /// Marks the edge_begin entries of nodes with bitmap index.
+  static const unsigned long bitmap_flag = 1UL << (8*sizeof(unsigned long)-1);
+
+  /** The number of items a word of a bitmap index covers.
+    *
+    * A bitmap index over the items 0 ... n-1 is a sequence of pairs of STATE words. Bit b of the first word of pair w is set
+    * if item w*bitmap_bits+b is the label of an edge, the second word (the rank) is the number of labels less than w*bitmap_bits.
+    * The position of a label among the sorted labels is its rank plus the number of set bits below it in its word,
+    * so a child is found by a single popcount, while the index needs only 2 bits per item.
+    */
+  static const unsigned bitmap_bits = 8*sizeof(STATE);
+
+  /// Returns the number of STATE words of a bitmap index over item_number items.
+  static unsigned long bitmap_words( const unsigned long item_number )
+  {
+     return 2*((item_number+bitmap_bits-1)/bitmap_bits);
+  }
+
+  /// Builds the bitmap index of the given sorted labels.
+  static void build_bitmap( const ITEM* items, const unsigned long item_number, const unsigned long word_number, STATE* bitmap );
+
+  /// Returns true and the position of item among the labels if item is a label of the bitmap index.
+  static bool bitmap_find( const STATE* bitmap, const ITEM item, unsigned long& position )
+  {
+     const STATE* word = bitmap + 2*(item/bitmap_bits);
+     const STATE  mask = (STATE) 1 << (item%bitmap_bits);
+     if( !(*word & mask) ) return false;
+     position = word[1] + __builtin_popcountl( (unsigned long) (*word & (mask-1)) );
+     return true;
+  }
 
 
 };
@@ -8,264 +8,237 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <algorithm>
+#include <functional>
 using namespace std;
 #include "Trie_hash.hpp"
+#include "Pair_counter.hpp"
+#include "Result_writer.hpp"
 
 /**
+  The bitmap index is cut from the end of the children.
       \param stateIndex The node that has to be altered.
   */
-void Trie_hash::from_hash_to_normal( const unsigned long stateIndex )
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::from_hash_to_normal( const STATE stateIndex )
 {
-   itemtype item_index1 = 0, item_index2 = 1;
    type_vector[stateIndex] = true;
-   itemarray[stateIndex].resize( statearray[stateIndex][0] );
-   while( item_index1 < itemarray[stateIndex].size() )
-   {
-      if( statearray[stateIndex][item_index2] )
-      {
-         itemarray[stateIndex][item_index1] = item_index2;
-         statearray[stateIndex][item_index1] = statearray[stateIndex][item_index2];
-         item_index1++;
-      }
-      item_index2++;
-   }
-   statearray[stateIndex].resize(itemarray[stateIndex].size());
+   statearray[stateIndex].resize( itemarray[stateIndex].size() );
+   vector<STATE>( statearray[stateIndex] ).swap( statearray[stateIndex] );
 }
 
 /**
+  The bitmap index of the labels is appended to the children.
      \param stateIndex The node that has to be altered.
   */
-void Trie_hash::from_normal_to_hash( const unsigned long stateIndex )
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::from_normal_to_hash( const STATE stateIndex )
 {
    type_vector[stateIndex] = false;
-   vector<unsigned long> temp_allapotvektor( statearray[stateIndex] );
-   statearray[stateIndex].assign( hash_modulus, 0 );
-   statearray[stateIndex][0] = itemarray[stateIndex].size();
-   for( itemtype item_index = 0; item_index < itemarray[stateIndex].size(); item_index++)
-      statearray[stateIndex][itemarray[stateIndex][item_index]] = temp_allapotvektor[item_index];
-   itemarray[stateIndex].clear();
+   const unsigned long word_number = Base::bitmap_words( hash_modulus );
+   vector<STATE> temp_allapotvektor;
+   temp_allapotvektor.reserve( itemarray[stateIndex].size() + word_number );
+   temp_allapotvektor.assign( statearray[stateIndex].begin(), statearray[stateIndex].end() );
+   temp_allapotvektor.resize( itemarray[stateIndex].size() + word_number );
+   Base::build_bitmap( itemarray[stateIndex].data(), itemarray[stateIndex].size(), word_number,
+                       temp_allapotvektor.data() + itemarray[stateIndex].size() );
+   statearray[stateIndex].swap( temp_allapotvektor );
 }
 
-void Trie_hash::delete_edge( const unsigned long fromState, const unsigned long toState )
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::delete_edge( const STATE fromState, const STATE toState )
 {
-   if( type_vector[fromState] ) return Trie::delete_edge( fromState, toState );
+   if( type_vector[fromState] ) Base::delete_edge( fromState, toState );
    else
    {
-      for( itemtype edge_index = 1; edge_index < hash_modulus; edge_index++ )
-         if (statearray[fromState][edge_index] == toState)
-         {
-            statearray[fromState][edge_index] = 0;
-            if( itemarray[fromState].size() < child_threshold+1 ) from_hash_to_normal( fromState );
-            if( itemarray[fromState].empty() )
-            {
-               maxpath[fromState] = 0;
-               max_path_set( parent[fromState] );
-            }
-         }
+      from_hash_to_normal( fromState );
+      Base::delete_edge( fromState, toState );
+      if( itemarray[fromState].size() > child_threshold ) from_normal_to_hash( fromState );
    }
 }
 
-void Trie_hash::max_path_set( const unsigned long stateIndex )
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::add_empty_state( const STATE fromState, const ITEM item, const COUNTER counter )
 {
-   if (type_vector[stateIndex]) Trie::max_path_set(stateIndex);
+   if( type_vector[fromState] ) Base::add_empty_state( fromState, item, counter );
    else
    {
-      itemtype temp_max_path=0;
-      for (unsigned short edge_index=1;edge_index<hash_modulus;edge_index++)
-        if (statearray[stateIndex][edge_index] && temp_max_path<maxpath[statearray[stateIndex][edge_index]]+1 )
-           temp_max_path=maxpath[statearray[stateIndex][edge_index]]+1;
-      if (maxpath[stateIndex] != temp_max_path )
-      {
-         maxpath[stateIndex] = temp_max_path;
-         if( stateIndex ) max_path_set( parent[stateIndex] );
-      }
+      from_hash_to_normal( fromState );
+      Base::add_empty_state( fromState, item, counter );
+      from_normal_to_hash( fromState );
    }
+   type_vector.push_back( true );
 }
 
-void Trie_hash::add_empty_state( const unsigned long fromState, const itemtype item, const unsigned long counter )
+template <class ITEM, class STATE, class COUNTER>
+STATE Trie_hash<ITEM,STATE,COUNTER>::child( const STATE state_index, const ITEM item ) const
 {
-  type_vector.push_back(true);
-  Trie::add_empty_state(fromState, item, counter);
+   if( type_vector[state_index] ) return Base::child( state_index, item );
+   unsigned long position;
+   if( Base::bitmap_find( statearray[state_index].data() + itemarray[state_index].size(), item, position ) )
+      return statearray[state_index][position];
+   else return 0;
 }
 
-unsigned long Trie_hash::is_included( const set<itemtype>& an_itemset ) const
+
+/**
+  The leaves that got more than child_threshold children are altered to hash tables.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::splice_candidates( const typename Base::Candidate_buffer& buffer )
 {
-   unsigned long hol = 0;
-   vector<itemtype>::const_iterator it_itemvector;
-   for (set<itemtype>::const_iterator item_it = an_itemset.begin();item_it != an_itemset.end(); item_it++)
-   {
-      if( type_vector[hol] )
-      {
-         it_itemvector = lower_bound( itemarray[hol].begin(), itemarray[hol].end(), *item_it );
-         if (it_itemvector != itemarray[hol].end() && *it_itemvector == *item_it)
-            hol = statearray[hol][it_itemvector-itemarray[hol].begin()];
-         else return 0;
-      }
-      else if( (hol = statearray[hol][*item_it]) == 0 ) return 0;
-   }
-   return hol;
+   Base::splice_candidates( buffer );
+   for( unsigned long leaf_index = 0; leaf_index < buffer.leaves.size(); leaf_index++ )
+      if( itemarray[buffer.leaves[leaf_index]].size() > child_threshold ) from_normal_to_hash( buffer.leaves[leaf_index] );
 }
 
+/**
+  Hash tables (and the nodes chosen by choose_representation) keep a bitmap index in the frozen image, it covers every frequent item.
+*/
+template <class ITEM, class STATE, class COUNTER>
+ITEM Trie_hash<ITEM,STATE,COUNTER>::bitmap_size( const STATE stateIndex ) const
+{
+   if( !type_vector[stateIndex] || (stateIndex < image_bitmap.size() && image_bitmap[stateIndex]) ) return hash_modulus;
+   else return 0;
+}
 
-void Trie_hash::candidate_generation_assist( unsigned long actual_state, const itemtype frequent_size,
-                                             const itemtype actual_size, set<itemtype>& maybe_candidate )
+/**
+  The cost model compares the two representations of an inner node of the image for the next counting.
+  A visit of a node with f children (in the image) and l basket items left costs about l+f*l/(l+1) steps by the merge of the sorted edges,
+  since the merge stops at the last item of the basket, and l steps by the bitmap index.
+  The number of visits is the occurrence of the node scaled by the ratio of the visits and the occurrences at its depth
+  in the last counting (the profile), and l is the average number of items left at its depth.
+  For the depth of the last candidates, which have not been inner nodes yet, l is estimated from the depth above,
+  and without a profile (first counting of the trie) from the average basket length.
+  A node gets a bitmap index if the saved steps exceed the size of the index (it has to be built for every level),
+  and the nodes with the largest saving are chosen until the bitmap indices fill the memory budget.
+  \param candidate_size The size of the candidates that will be counted.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::choose_representation( const ITEM candidate_size )
 {
-   if ( type_vector[actual_state] ) Trie::candidate_generation_assist( actual_state, frequent_size, actual_size, maybe_candidate);
-   else
+   if( !self_tuning ) return;
+   const unsigned long word_number = Base::bitmap_words( hash_modulus ),
+                       index_memory = word_number*sizeof(STATE);
+   vector<STATE>       order( 1, 0 );
+   vector<ITEM>        order_depth( 1, 0 );
+   vector< pair<double,STATE> > savings;
+
+   decision = Decision();
+   decision.candidate_size = candidate_size;
+   decision.budget = memory_budget;
+   if( !decision.budget )
+      for( STATE stateIndex = 0; stateIndex < itemarray.size(); stateIndex++ )
+         decision.budget += itemarray[stateIndex].capacity()*sizeof(ITEM) + statearray[stateIndex].capacity()*sizeof(STATE);
+   image_bitmap.assign( itemarray.size(), false );
+   for( unsigned long order_index = 0; order_index < order.size(); order_index++ )
    {
-      itemtype edge_index;
-      if( actual_size == frequent_size )
-      {
-         from_hash_to_normal( actual_state );
-         Trie::candidate_generation_assist( actual_state, frequent_size, actual_size, maybe_candidate );
-         for( edge_index = 0; edge_index < itemarray[actual_state].size(); edge_index++)
-           if( itemarray[statearray[actual_state][edge_index]].size() > child_threshold )
-              from_normal_to_hash( statearray[actual_state][edge_index] );
-         from_normal_to_hash( actual_state );
-      }
-      else
-      {
-         for( edge_index = 1; edge_index < hash_modulus; edge_index++) if( statearray[actual_state][edge_index] )
+      const ITEM depth = order_depth[order_index];
+      if( depth == candidate_size ) continue;
+      const STATE stateIndex = order[order_index];
+      unsigned long child_number = 0;
+      for( ITEM edge_index = 0; edge_index < itemarray[stateIndex].size(); edge_index++ )
+         if( maxpath[statearray[stateIndex][edge_index]]+depth+1 == candidate_size )
          {
-            maybe_candidate.insert( edge_index );
-            candidate_generation_assist( statearray[actual_state][edge_index], frequent_size, actual_size+1, maybe_candidate);
-            maybe_candidate.erase( edge_index );
+            order.push_back( statearray[stateIndex][edge_index] );
+            order_depth.push_back( depth+1 );
+            child_number++;
          }
-      }
-   }
-}
+      decision.inner_nodes++;
 
-void Trie_hash::find_candidate_more( const vector<itemtype>& basket, const itemtype candidate_size,
-                                     vector<itemtype>::const_iterator it_basket, const unsigned long actual_state,
-                                     const itemtype actual_size, const unsigned long counter)
-{
-   if( candidate_size == actual_size )
-      countervector[actual_state] += counter;
-   else
+      double visits = countervector[stateIndex],
+             left;
+      if( depth < profile.supports.size() && profile.supports[depth] )
+         visits *= (double) profile.visits[depth] / profile.supports[depth];
+      if( depth < profile.items.size() && profile.items[depth] )
+         left = (double) profile.items[depth] / profile.visits[depth];
+      else if( depth && depth <= profile.items.size() && profile.items[depth-1] )
+         left = ((double) profile.items[depth-1] / profile.visits[depth-1] - 1) / 2;
+      else left = average_length - depth;
+      if( left < 1 ) left = 1;
+      const double saving = visits * child_number * left / (left+1);
+      if( saving > word_number ) savings.push_back( pair<double,STATE>( saving, stateIndex ) );
+   }
+   sort( savings.begin(), savings.end(), greater< pair<double,STATE> >() );
+   for( unsigned long saving_index = 0; saving_index < savings.size(); saving_index++ )
    {
-      if( type_vector[actual_state] ) Trie::find_candidate_more( basket, candidate_size, it_basket, actual_state, actual_size,counter );
-      else for (;candidate_size < basket.end()-it_basket+actual_size+1; it_basket++)
-              if( statearray[actual_state][*it_basket] && maxpath[statearray[actual_state][*it_basket]]+actual_size+1 == candidate_size)
-                 find_candidate_more( basket, candidate_size, it_basket+1, statearray[actual_state][*it_basket], actual_size+1,counter );
-
+      if( decision.bitmap_memory + index_memory > decision.budget ) break;
+      image_bitmap[savings[saving_index].second] = true;
+      decision.bitmap_nodes++;
+      decision.bitmap_memory += index_memory;
    }
 }
 
-void Trie_hash::delete_infrequent_one( const unsigned long min_occurrence )
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::set_first_level( const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                                                     const unsigned long min_occurrence )
 {
-  Trie::delete_infrequent_one( min_occurrence );
+  Base::set_first_level( item_counters, basket_number, min_occurrence );
   hash_modulus = itemarray.size();
+  average_length = 0;
+  for( STATE stateIndex = 1; stateIndex < itemarray.size(); stateIndex++ ) average_length += countervector[stateIndex];
+  if( countervector[0] ) average_length /= countervector[0];
 }
 
-void Trie_hash::delete_infrequent_two( const unsigned long min_occurrence )
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::delete_infrequent_two( const unsigned long min_occurrence )
 {
-  Trie::delete_infrequent_two( min_occurrence );
-  for( unsigned long stateIndex = 0; stateIndex < itemarray.size(); stateIndex++ )
+  Base::delete_infrequent_two( min_occurrence );
+  for( STATE stateIndex = 0; stateIndex < itemarray.size(); stateIndex++ )
      if( itemarray[stateIndex].size() > child_threshold ) from_normal_to_hash( stateIndex );
      else type_vector[stateIndex] = true;
 }
 
-void Trie_hash::delete_infrequent_more( const unsigned long min_occurrence )
+/**
+  The hash tables are altered to normal nodes while the infrequent candidates are deleted,
+  then the nodes that still have more than child_threshold children get their bitmap index again.
+*/
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::delete_infrequent_more( const unsigned long min_occurrence )
 {
-   unsigned long stateIndex = 1,
-                 stateIndex2,
-                 os;
-
-   for( stateIndex2 = 1; stateIndex2 < itemarray.size(); stateIndex2++ )
-   {
-      os = parent[stateIndex2];
-      if( countervector[stateIndex2] >= min_occurrence )
-      {
-         if( stateIndex != stateIndex2)
-         {
-            vector<unsigned long>::iterator it_state;
-            if( type_vector[os] ) it_state = lower_bound( statearray[os].begin(), statearray[os].end(), stateIndex2 );
-            else it_state = lower_bound( statearray[os].begin()+1, statearray[os].end(), stateIndex2);
-            *it_state = stateIndex;
-            itemarray[stateIndex] = itemarray[stateIndex2];
-            statearray[stateIndex] = statearray[stateIndex2];
-            parent[stateIndex] = parent[stateIndex2];
-            countervector[stateIndex] = countervector[stateIndex2];
-            type_vector[stateIndex] = type_vector[stateIndex2];
-            maxpath[stateIndex] = maxpath[stateIndex2];
-         }
-         stateIndex++;
-      }
-      else delete_edge( os, stateIndex2 );
-   }
-   itemarray.resize( stateIndex );
-   statearray.resize( stateIndex );
-   parent.resize( stateIndex );
-   countervector.resize( stateIndex );
-   maxpath.resize( stateIndex );
-   type_vector.resize( stateIndex );
+   STATE stateIndex;
+   for( stateIndex = 0; stateIndex < itemarray.size(); stateIndex++ )
+      if( !type_vector[stateIndex] ) from_hash_to_normal( stateIndex );
+   Base::delete_infrequent_more( min_occurrence );
+   type_vector.assign( itemarray.size(), true );
+   for( stateIndex = 0; stateIndex < itemarray.size(); stateIndex++ )
+      if( itemarray[stateIndex].size() > child_threshold ) from_normal_to_hash( stateIndex );
 }
 
-
-void Trie_hash::assoc_rule_assist( ofstream& outcomefile, const double min_conf,
-                                   unsigned long actual_state, set<itemtype>& consequence_part) const
+/**
+  \param child_threshold_in Nodes with more children are altered to hash tables. If it is 0, the nodes of the trie stay normal nodes
+         and choose_representation decides on the representation in the frozen image.
+  \param memory_budget_in The memory of the bitmap indices chosen by choose_representation (0: the memory of the edges of the trie).
+*/
+template <class ITEM, class STATE, class COUNTER>
+Trie_hash<ITEM,STATE,COUNTER>::Trie_hash( const itemtype child_threshold_in, const unsigned long memory_budget_in ):
+   Base(),self_tuning(!child_threshold_in),memory_budget(memory_budget_in),average_length(0)
 {
-   if( type_vector[actual_state] ) Trie::assoc_rule_assist( outcomefile, min_conf, actual_state,consequence_part );
-   else
-   {
-      if( consequence_part.size() > 1 )
-      {
-         set<itemtype> condition_part;
-         assoc_rule_find(outcomefile, min_conf, condition_part, consequence_part, countervector[actual_state]);
-      }
-
-      itemtype edge_index;
-      for( edge_index = 1; edge_index < hash_modulus; edge_index++)
-         if( statearray[actual_state][edge_index] )
-         {
-            consequence_part.insert( edge_index );
-            assoc_rule_assist( outcomefile, min_conf, statearray[actual_state][edge_index], consequence_part);
-            consequence_part.erase( edge_index );
-         }
-   }
+   child_threshold = self_tuning ? numeric_limits<itemtype>::max() : child_threshold_in;
+   type_vector.push_back( true );
 }
 
-void Trie_hash::write_content_to_file_assist( ofstream& outcomefile, const unsigned long actual_state,
-                                              const itemtype item_size, const itemtype actual_size,
-                                              set<itemtype>& frequent_itemset ) const
+template <class ITEM, class STATE, class COUNTER>
+unsigned long Trie_hash<ITEM,STATE,COUNTER>::memory() const
 {
-   if (type_vector[actual_state] || actual_size == item_size)
-      Trie::write_content_to_file_assist( outcomefile, actual_state, item_size, actual_size, frequent_itemset );
-   else for( itemtype item_index = 1; item_index < hash_modulus; item_index++ )
-           if( statearray[actual_state][item_index] && maxpath[statearray[actual_state][item_index]]+actual_size+1 >= item_size)
-           {
-              frequent_itemset.insert( item_index );
-              write_content_to_file_assist( outcomefile, statearray[actual_state][item_index], item_size, actual_size+1, frequent_itemset );
-              frequent_itemset.erase( item_index );
-           }
+   return Base::memory() + (type_vector.capacity()+image_bitmap.capacity())/8;
 }
 
-Trie_hash::Trie_hash( const itemtype child_threshold_in ):Trie()
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::statistics() const
 {
-   child_threshold = child_threshold_in;
-   type_vector.push_back( true );
-}
-void Trie_hash::statistics() const
-{
-   unsigned long mem = itemarray.capacity() + statearray.capacity()+
-                       countervector.capacity()+ maxpath.capacity()+ parent.capacity()+type_vector.capacity();
-
-   for( unsigned long stateIndex = 0; stateIndex < itemarray.size(); stateIndex++)
-       if( type_vector[stateIndex] ) mem += itemarray[stateIndex].capacity() + statearray[stateIndex].capacity();
-    else mem += hash_modulus * sizeof(long);
-    if( maxpath[0] == 2 && itemarray[0].size()+1 == itemarray.size() )
-       mem += (itemarray.size()-1) * (itemarray.size()-2) * sizeof(long)/2+(itemarray.size()-1) * sizeof(unsigned long*);
-//   cout<<"\nA szofa allapotainak szama: "<<itemarray.size();
-   cout << "The memory need is: ";
-   if (mem/1048576) cout << mem/1048576 <<" Mbyte + ";
-   if ((mem%1048576)/1024) cout << (mem%1048576)/1024 << " Kbyte + ";
-   cout<<mem%1024 << " byte" << endl;
+   Base::statistics();
+   if( self_tuning && decision.candidate_size )
+      cout << "Bitmap indices for the " << decision.candidate_size << "-itemset candidates: " << decision.bitmap_nodes << " of "
+           << decision.inner_nodes << " inner nodes, " << decision.bitmap_memory/1024 << " Kbyte (budget: "
+           << decision.budget/1024 << " Kbyte)." << endl;
 }
 
-void Trie_hash::show_content() const
+template <class ITEM, class STATE, class COUNTER>
+void Trie_hash<ITEM,STATE,COUNTER>::show_content() const
 {
-   unsigned long stateIndex;
-   itemtype      edge_index;
+   STATE         stateIndex;
+   ITEM          edge_index;
 
    cout << "\nSize:" << itemarray.size();
    for( stateIndex = 0; stateIndex < itemarray.size(); stateIndex++)
@@ -282,18 +255,23 @@ void Trie_hash::show_content() const
       else
       {
          cout << " hash tbla, levelei:";
-         for( edge_index = 1; edge_index < hash_modulus; edge_index++ )
-            if( statearray[stateIndex][edge_index] ) cout << "\n " << edge_index << "hatasara" << statearray[stateIndex][edge_index];
+         for( edge_index = 0; edge_index < itemarray[stateIndex].size(); edge_index++)
+            cout << "\n " << itemarray[stateIndex][edge_index] << "hatasara" << statearray[stateIndex][edge_index];
       }
    }
-   if ( maxpath[0] == 1 && itemarray[0].size()+1 < itemarray.size())
+   if ( maxpath[0] == 2 && itemarray[0].size()+1 == itemarray.size())
    {
       cout << endl << "Content of 2D table (counters of itempairs)";
-      for( stateIndex = 0; stateIndex < itemarray[0].size()-1; stateIndex++ )
+      for( stateIndex = 1; stateIndex < itemarray[0].size(); stateIndex++ )
       {
          cout << endl;
-         for( edge_index = 0; edge_index < itemarray[0].size()-1-stateIndex; edge_index++ )
-            cout << temp_counter_array[stateIndex][edge_index] << ',';
+         for( edge_index = stateIndex+1; edge_index <= itemarray[0].size(); edge_index++ )
+            cout << temp_counter_array->get( stateIndex, edge_index ) << ',';
       }
    }
 }
+
+template class Trie_hash<unsigned short, unsigned int, unsigned int>;
+template class Trie_hash<unsigned short, unsigned int, unsigned long>;
+template class Trie_hash<unsigned int, unsigned int, unsigned int>;
+template class Trie_hash<unsigned int, unsigned int, unsigned long>;
@@ -16,53 +16,88 @@
   *@author Ferenc Bodon
   */
 
-class Trie_hash : public Trie
+template <class ITEM, class STATE, class COUNTER> class Trie_hash : public Trie<ITEM,STATE,COUNTER>
 {
 public:
 
-   Trie_hash( const itemtype child_threshold_in=5 );
+   Trie_hash( const itemtype child_threshold_in=5, const unsigned long memory_budget_in=0 );
+   void set_first_level( const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                         const unsigned long min_occurrence );
+   unsigned long memory() const;
    void statistics() const;
    void show_content() const;
 
 private:
 
+   typedef Trie<ITEM,STATE,COUNTER> Base;
+   using Base::itemarray;
+   using Base::statearray;
+   using Base::countervector;
+   using Base::parent;
+   using Base::maxpath;
+   using Base::temp_counter_array;
+   using Base::frozen;
+   using Base::profile;
+
    //! Alters a node from hash table to normal node.
-   void from_hash_to_normal( const unsigned long state_index );
+   void from_hash_to_normal( const STATE state_index );
 
    //! Alters a node from normal node to hash table.
-   void from_normal_to_hash( const unsigned long state_index );
+   void from_normal_to_hash( const STATE state_index );
 
-   void delete_edge( const unsigned long from_state, const unsigned long to_state );
-   void max_path_set( const unsigned long state_index );
-   void add_empty_state( const unsigned long from_state, const itemtype item, const unsigned long counter );
-   unsigned long is_included( const set<itemtype>& an_itemset ) const;
-   void delete_infrequent_one( const unsigned long min_occurrence );
+   void delete_edge( const STATE from_state, const STATE to_state );
+   void add_empty_state( const STATE from_state, const ITEM item, const COUNTER counter );
+   STATE child( const STATE state_index, const ITEM item ) const;
    void delete_infrequent_two( const unsigned long min_occurrence );
    void delete_infrequent_more( const unsigned long min_occurrence );
-   void candidate_generation_assist( unsigned long actual_state,const itemtype frequent_size,
-                                     const itemtype actual_size, set<itemtype>& maybe_candidate );
-   void find_candidate_more( const vector<itemtype>& basket, const itemtype candidate_size,
-                             vector<itemtype>::const_iterator it_basket, const unsigned long actual_state,
-                             const itemtype actual_size, const unsigned long counter=1 );
-   void assoc_rule_assist( ofstream& outcomefile,const double min_conf, unsigned long actual_state, set<itemtype>& consequence_part ) const;
-   void write_content_to_file_assist( ofstream& outcomefile, const unsigned long actual_state,
-                                      const itemtype item_size, const itemtype actual_size, set<itemtype>& frequent_itemset ) const;
+   void splice_candidates( const typename Base::Candidate_buffer& buffer );
+   ITEM bitmap_size( const STATE state_index ) const;
+   void choose_representation( const ITEM candidate_size );
 
    /** It stores the type of the nodes.
      *
      * If type_vector[i] is true, the i<sup>th</sup> node is an original node,
-     * otherwise it is a hash table.
+     * otherwise it is a hash table. A hash table keeps its edges in itemarray and statearray like an original node,
+     * but statearray also contains a bitmap index over all the frequent items after the children (see Trie::bitmap_bits),
+     * so a child is found by a single popcount instead of a binary search.
+     * The index takes 2 bits per frequent item, a directly addressed table would take a STATE per frequent item.
      */
    vector<bool> type_vector;
 
    /** \brief When the child number of a node is higher than child_threshold it is altered to hash table.*/
    itemtype child_threshold;
 
-   /** The modulus of the hash table.
+   /** The number of items the bitmap indices cover.
      *
-     * Since hash tables have to be perfect the hash modulus equals the number of frequent items.
+     * A bitmap has a bit for every item code (0 ... the number of frequent items), so the width is the number of frequent items plus one.
+     */
+   ITEM hash_modulus;
+
+   /** If true, the nodes of the trie stay normal nodes and choose_representation decides
+     * which nodes get a bitmap index in the frozen image (child_threshold is 0 in the constructor).
      */
-   itemtype hash_modulus;
+   bool self_tuning;
+
+   /// The memory the bitmap indices of the frozen image may use in self tuning mode (0: the memory of the edges of the trie).
+   unsigned long memory_budget;
+
+   /// image_bitmap[i] is true if the i<sup>th</sup> node gets a bitmap index in the frozen image (self tuning mode).
+   vector<bool> image_bitmap;
+
+   /// The average number of frequent items in a basket.
+   double average_length;
+
+   /// The last decision of choose_representation, it is reported by statistics.
+   struct Decision
+   {
+      Decision():candidate_size(0),inner_nodes(0),bitmap_nodes(0),bitmap_memory(0),budget(0) {}
+
+      ITEM          candidate_size;
+      unsigned long inner_nodes,
+                    bitmap_nodes,
+                    bitmap_memory,
+                    budget;
+   } decision;
 
 
 };
@@ -35,7 +35,9 @@ An association rule is <em>valid</em> if its confidence, support and lift are gr
 #include <fstream>
 #include <unistd.h>
 #include <getopt.h>
+#include <cstring>
 #include "Apriori.hpp"
+#include "Eclat.hpp"
 using namespace std;
 
 /// This procedure displays the usage of the program.
@@ -55,9 +57,56 @@ void usage()
    cerr << "\n\t\t    Hash technique is applied at nodes,";
    cerr << "\n\t\t    that have children more than num,";
    cerr << "\n\t\t    type --trie_hash 0 for default (5) child threshold,";
+   cerr << "\n\t\t    type --hash auto to choose the nodes by a cost model";
+   cerr << "\n\t\t    from the lookups measured at the last counting.";
+   cerr << "\n --hash_memory <num>\n  -m <num>\t    memory budget of --hash auto in Mbyte. Default: the";
+   cerr << "\n\t\t    memory of the edges of the trie.";
    cerr << "\n --no_store_input\n  -s\t\t    Do not store filtered basket (i.e frequent items";
    cerr << "\n\t\t    in the basket) in memory. This decreases memory need,";
    cerr << "\n\t\t    but slows down the algorithm!";
+   cerr << "\n --bundle_memory <num>\n  -u <num>\t    with --no_store_input count two levels in one scan";
+   cerr << "\n\t\t    if the candidates of the second level fit in num";
+   cerr << "\n\t\t    Mbyte. The first level generates them before it is";
+   cerr << "\n\t\t    counted, so some of them are not real candidates.";
+   cerr << "\n --basket_tree\n  -b\t\t    Store the filtered baskets in a prefix tree and count";
+   cerr << "\n\t\t    the candidates on its subtrees, so common prefixes";
+   cerr << "\n\t\t    of the baskets are processed only once.";
+   cerr << "\n --trim_baskets\n  -r\t\t    After every scan remove those items from the stored";
+   cerr << "\n\t\t    baskets that are not contained by enough candidates";
+   cerr << "\n\t\t    of the basket to be in any larger candidate.";
+   cerr << "\n --top_k <num>\n  -k <num>\t    mine the num most frequent itemsets of size at least";
+   cerr << "\n\t\t    two (and the ones that have the same support as the";
+   cerr << "\n\t\t    last of them). The support threshold is raised while";
+   cerr << "\n\t\t    the candidates are counted, min_supp is its lower";
+   cerr << "\n\t\t    bound. --top-k is the same option.";
+   cerr << "\n --sample <num>\n  -p <num>\t    mine a random sample of num fraction of the baskets";
+   cerr << "\n\t\t    with a lowered support threshold, then verify it";
+   cerr << "\n\t\t    and its negative border with one scan of the whole";
+   cerr << "\n\t\t    database. The larger itemsets are mined again only";
+   cerr << "\n\t\t    if the sample misses a frequent itemset.";
+   cerr << "\n --partition <num>\n  -c <num>\t    split the basket file into partitions of num Mbyte";
+   cerr << "\n\t\t    and mine them in the memory (with --threads several";
+   cerr << "\n\t\t    of them at the same time), then verify the union";
+   cerr << "\n\t\t    of their frequent itemsets with one scan of the";
+   cerr << "\n\t\t    whole database. Only the partitions are stored.";
+   cerr << "\n --workers <num>\n  -w <num>\t    split the basket file into num shards, count them";
+   cerr << "\n\t\t    with num worker processes (each of them keeps a";
+   cerr << "\n\t\t    copy of the trie), and add up their counters.";
+   cerr << "\n --threads <num>\n  -n <num>\t    count the stored baskets, generate the candidates";
+   cerr << "\n\t\t    and the association rules with num threads.";
+   cerr << "\n --engine <name>\n  -e <name>\t    apriori (default) or eclat. ECLAT mines the";
+   cerr << "\n\t\t    vertical representation (tidsets) depth-first,";
+   cerr << "\n\t\t    it does not generate association rules.";
+   cerr << "\n --min_lift <num>\n  -l <num>\t    lift threshold of the association rules (the rules";
+   cerr << "\n\t\t    need min_conf). Default: 0 (no lift threshold).";
+   cerr << "\n --format <name>\n  -f <name>\t    text (default) or binary. The binary format stores";
+   cerr << "\n\t\t    the itemsets as varints (delta coded items and the";
+   cerr << "\n\t\t    occurrence), recode_reformat/read_itemsets converts";
+   cerr << "\n\t\t    it to text. Association rules need the text format.";
+   cerr << "\n --metrics <file>\n  -j <file>\t    write the measurements of the run into file as JSON:";
+   cerr << "\n\t\t    the candidates, the frequent itemsets, the scanned";
+   cerr << "\n\t\t    baskets, the wall clock and CPU time of the counting,";
+   cerr << "\n\t\t    deletion and generation, and the memory of every level.";
 
    cerr << "\n\nFile formats:";
    cerr << "\n\nThe basket file is a plan text file. Each row represents a basket.";
@@ -69,15 +118,33 @@ void usage()
 
 int main( int argc, char *argv[] )
 {
-   double min_supp,min_conf;
-   int trie_type=1, child_threshold=30, optch, cmdindex=0;
-   char stropts[]="ht:s";
-   bool store_input=true;
+   double min_supp,min_conf,min_lift=0;
+   int trie_type=1, child_threshold=30, threads=1, workers=0, optch, cmdindex=0;
+   unsigned long hash_memory=0, bundle_memory=0, top_k=0, partition_memory=0;
+   double sample_fraction=0;
+   const char* metrics_filename=0;
+   char stropts[]="ht:sbrn:e:f:l:m:u:k:p:c:w:j:";
+   bool store_input=true, eclat=false, basket_tree=false, trim_baskets=false;
+   Result_writer::format_type format=Result_writer::TEXT;
    struct option lopts[]=
    {
       {"help",0,0,'h'},
       {"store_input",0,0,'s'},
+      {"basket_tree",0,0,'b'},
+      {"trim_baskets",0,0,'r'},
       {"hash",1,0,'t'},
+      {"threads",1,0,'n'},
+      {"engine",1,0,'e'},
+      {"format",1,0,'f'},
+      {"min_lift",1,0,'l'},
+      {"hash_memory",1,0,'m'},
+      {"bundle_memory",1,0,'u'},
+      {"top_k",1,0,'k'},
+      {"top-k",1,0,'k'},
+      {"sample",1,0,'p'},
+      {"partition",1,0,'c'},
+      {"workers",1,0,'w'},
+      {"metrics",1,0,'j'},
       {0,0,0,0}
    };
 
@@ -86,10 +153,46 @@ int main( int argc, char *argv[] )
      {
         case 'h' : usage();exit(1);
         case 's' : store_input = false; break;
+        case 'b' : basket_tree = true; break;
+        case 'r' : trim_baskets = true; break;
         case 't' : trie_type = 2;
+                if (!strcmp(optarg,"auto")) {child_threshold = 0; break;}   // Trie_hash chooses the nodes
                 child_threshold=atoi(optarg);
                 if (child_threshold<1) child_threshold = 30;
                 break;
+        case 'm' : hash_memory = strtoul(optarg,0,10)*1048576UL;
+                break;
+        case 'u' : bundle_memory = strtoul(optarg,0,10)*1048576UL;
+                break;
+        case 'k' : top_k = strtoul(optarg,0,10);
+                if (!top_k) {cerr<<"\nThe number of the itemsets of --top_k should be positive.\nType --help for help.\n"; exit(1);}
+                break;
+        case 'p' : sample_fraction = atof(optarg);
+                if (sample_fraction<=0 || sample_fraction>1)
+                {cerr<<"\nThe fraction of --sample should be in the interval (0,1].\nType --help for help.\n"; exit(1);}
+                break;
+        case 'c' : partition_memory = strtoul(optarg,0,10)*1048576UL;
+                if (!partition_memory) {cerr<<"\nThe size of the partitions of --partition should be positive.\nType --help for help.\n"; exit(1);}
+                break;
+        case 'w' : workers = atoi(optarg);
+                if (workers<1) {cerr<<"\nThe number of the --workers should be positive.\nType --help for help.\n"; exit(1);}
+                break;
+        case 'j' : metrics_filename = optarg;
+                break;
+        case 'n' : threads = atoi(optarg);
+                if (threads<1) threads = 1;
+                break;
+        case 'e' : if (!strcmp(optarg,"eclat")) eclat = true;
+                else if (!strcmp(optarg,"apriori")) eclat = false;
+                else {cerr<<"\nUnknown engine: "<<optarg<<"\nType --help for help.\n"; exit(1);}
+                break;
+        case 'l' : min_lift = atof(optarg);
+                if (min_lift<0) min_lift = 0;
+                break;
+        case 'f' : if (!strcmp(optarg,"binary")) format = Result_writer::BINARY;
+                else if (!strcmp(optarg,"text")) format = Result_writer::TEXT;
+                else {cerr<<"\nUnknown format: "<<optarg<<"\nType --help for help.\n"; exit(1);}
+                break;
 
         default:   cerr<<"\nType --help for help.\n"; exit(1);
      }
@@ -127,11 +230,111 @@ int main( int argc, char *argv[] )
          exit(1);
       }
    }
-   ofstream outcomefile(argv[optind+1]);
+   if ( eclat && min_conf )
+   {
+      cout << "\nError!\n Association rules are generated only by the apriori engine.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( min_lift && !min_conf )
+   {
+      cout << "\nError!\n The lift threshold can be used only with min_conf.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( eclat && top_k )
+   {
+      cout << "\nError!\n The support threshold is raised only by the apriori engine, --top_k can not be used with eclat.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( eclat && sample_fraction )
+   {
+      cout << "\nError!\n Only the apriori engine mines a sample, --sample can not be used with eclat.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( top_k && sample_fraction )
+   {
+      cout << "\nError!\n The threshold of the sample is derived from min_supp, --sample can not be used with --top_k.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( partition_memory && (eclat || !store_input || top_k || sample_fraction) )
+   {
+      cout << "\nError!\n The partitions are mined in the memory by the apriori engine with a fixed threshold, --partition can not";
+      cout << "\n be used with eclat, --no_store_input, --top_k or --sample.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( workers && (eclat || sample_fraction || partition_memory) )
+   {
+      cout << "\nError!\n The workers count the levels of the apriori engine, --workers can not be used with eclat, --sample";
+      cout << "\n or --partition.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( metrics_filename && eclat )
+   {
+      cout << "\nError!\n The phases of the apriori engine are measured, --metrics can not be used with eclat.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( basket_tree && !store_input )
+   {
+      cout << "\nError!\n The basket tree is built from the stored baskets, it can not be used with --no_store_input.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( bundle_memory && store_input )
+   {
+      cout << "\nError!\n The levels are counted in one scan only if the baskets are not stored, --bundle_memory needs --no_store_input.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( trim_baskets && (!store_input || basket_tree) )
+   {
+      cout << "\nError!\n Only the stored baskets can be trimmed, --trim_baskets can not be used with --no_store_input or --basket_tree.\n";
+      cout.flush();
+      exit(1);
+   }
+   if ( format == Result_writer::BINARY && min_conf )
+   {
+      cout << "\nError!\n Association rules are written only in text format.\n";
+      cout.flush();
+      exit(1);
+   }
+   ofstream outcomefile(argv[optind+1], format == Result_writer::BINARY ? ios::out | ios::binary : ios::out);
    if ( !outcomefile ) {cerr << "\nThe outcomefile can not be written!"<< flush; exit(1);}
 
-   Apriori apriori( store_input, trie_type, child_threshold );
-   apriori.APRIORI_alg( outcomefile, argv[optind], min_supp, min_conf );
+   Metrics metrics;
+   if ( metrics_filename ) Metrics::account_heap();
+   string  command_line = argv[0];
+   for ( int arg_index = 1; arg_index < argc; arg_index++ ) command_line = command_line + " " + argv[arg_index];
+   metrics.set_parameter( "command_line", command_line );
+   metrics.set_parameter( "engine", "apriori" );
+   metrics.set_parameter( "basket_file", argv[optind] );
+   metrics.set_parameter( "min_supp", min_supp );
+   metrics.set_parameter( "min_conf", min_conf );
+   metrics.set_parameter( "threads", threads );
+   metrics.set_parameter( "workers", workers );
+
+   if ( eclat )
+   {
+      Eclat eclat_engine( format );
+      eclat_engine.ECLAT_alg( outcomefile, argv[optind], min_supp );
+   }
+   else
+   {
+      Apriori_driver apriori( store_input, trie_type, child_threshold, threads, format, hash_memory, basket_tree, trim_baskets,
+                              bundle_memory, top_k, sample_fraction, partition_memory, workers );
+      apriori.APRIORI_alg( outcomefile, argv[optind], min_supp, min_conf, min_lift, metrics_filename ? &metrics : 0 );
+   }
    outcomefile.close();
+   if ( metrics_filename && !metrics.write( metrics_filename ) )
+   {
+      cerr << "\nThe metrics file can not be written!" << endl;
+      exit(1);
+   }
    return 0;
 }
@@ -0,0 +1,271 @@
+/***************************************************************************
+                          main_bench_counting.cpp  -  description
+                             -------------------
+ ***************************************************************************/
+
+//!  This program times the support counting kernels of the trie in isolation.
+/*!
+  The baskets are read into the memory and recoded once, then the levels are mined as APRIORI does.
+  After the real counting of a level the counters are saved (Trie::get_counters), and the counting kernel alone
+  is timed repeat times over the same baskets: find_candidate_two (the pair counters) at level 2,
+  and find_candidate_more (the walk of the frozen image with a private Counting_context) at the larger levels.
+  With --hash the trie is a Trie_hash, so the frozen image may contain bitmap indices. Then the counters are restored
+  (Trie::set_counters), and the infrequent candidates are deleted as usual.
+
+  The baskets that have fewer items than the candidates are skipped by the kernel (as by the pruning of the stored baskets),
+  the other ones are given one by one, without merging the identical baskets.
+
+  For every level the program reports the nanoseconds per basket (the minimum and the median of the repeats),
+  the node visits per basket (the nodes of the frozen image reached by the walk, or the pair counters increased at level 2)
+  and the last level cache misses per basket if the hardware counter can be opened by perf_event_open.
+*/
+
+#include "Trie.hpp"
+#include "Trie_hash.hpp"
+#include "Input_data.hpp"
+#include "Metrics.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+using namespace std;
+
+/// Counts the cache misses of the calling thread (it is not available in many virtual machines and containers).
+class Cache_miss_counter
+{
+public:
+   Cache_miss_counter()
+   {
+      perf_event_attr attributes;
+      memset( &attributes, 0, sizeof(attributes) );
+      attributes.size = sizeof(attributes);
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+      attributes.disabled = 1;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv = 1;
+      descriptor = syscall( __NR_perf_event_open, &attributes, 0, -1, -1, 0 );
+   }
+
+   ~Cache_miss_counter() {if( descriptor >= 0 ) close( descriptor );}
+
+   bool available() const {return descriptor >= 0;}
+
+   void start()
+   {
+      if( !available() ) return;
+      ioctl( descriptor, PERF_EVENT_IOC_RESET, 0 );
+      ioctl( descriptor, PERF_EVENT_IOC_ENABLE, 0 );
+   }
+
+   /// Returns the cache misses since start.
+   unsigned long stop()
+   {
+      unsigned long misses = 0;
+      if( !available() ) return 0;
+      ioctl( descriptor, PERF_EVENT_IOC_DISABLE, 0 );
+      if( read( descriptor, &misses, sizeof(misses) ) != sizeof(misses) ) misses = 0;
+      return misses;
+   }
+
+private:
+   int descriptor;
+};
+
+/// The baskets of the basket file, basket i is items[begins[i]] ... items[begins[i+1]-1].
+struct Baskets
+{
+   vector<itemtype>      items;
+   vector<unsigned long> begins;
+};
+
+/// Times the counting kernels of the levels of a trie of the given types.
+template <class ITEM, class STATE, class COUNTER>
+void benchmark( const Baskets& baskets, const vector<unsigned long>& item_counters, const unsigned long basket_number,
+                const unsigned long min_supp_abs, const int trie_type, const int child_threshold, const unsigned long repeat,
+                const unsigned long only_level )
+{
+   Trie<ITEM,STATE,COUNTER>* trie;
+   if( trie_type == 1 ) trie = new Trie<ITEM,STATE,COUNTER>();
+   else trie = new Trie_hash<ITEM,STATE,COUNTER>( child_threshold );
+   trie->set_first_level( item_counters, basket_number, min_supp_abs );
+
+   vector<itemtype>      basket;
+   vector<ITEM>          recoded_basket,
+                         items;
+   vector<unsigned long> begins( 1, 0 );
+   for( unsigned long basket_index = 0; basket_index+1 < baskets.begins.size(); basket_index++ )
+   {
+      basket.assign( baskets.items.begin()+baskets.begins[basket_index], baskets.items.begin()+baskets.begins[basket_index+1] );
+      trie->basket_recode( basket, recoded_basket );
+      if( recoded_basket.size() < 2 ) continue;
+      items.insert( items.end(), recoded_basket.begin(), recoded_basket.end() );
+      begins.push_back( items.size() );
+   }
+   cout << "Item codes: " << 8*sizeof(ITEM) << " bits, counters: " << 8*sizeof(COUNTER) << " bits, "
+        << (trie_type == 1 ? "Trie" : "Trie_hash") << ", " << begins.size()-1 << " baskets with at least two frequent items." << endl;
+
+   Cache_miss_counter misses;
+   cout << endl << setw( 5 ) << "size" << setw( 12 ) << "candidates" << setw( 10 ) << "baskets" << setw( 8 ) << "items"
+        << setw( 14 ) << "ns/basket" << setw( 14 ) << "(median)" << setw( 14 ) << "visits/basket" << setw( 14 ) << "misses/basket" << endl;
+   cout << fixed;
+
+   unsigned long trie_size = trie->node_number();
+   ITEM          candidate_size = 1;
+   trie->candidate_generation( candidate_size );
+   while( trie_size < trie->node_number() )
+   {
+      candidate_size++;
+      const unsigned long candidate_number = trie->node_number()-trie_size;
+      unsigned long       kernel_baskets = 0,
+                          kernel_items = 0,
+                          pair_visits = 0;
+      for( unsigned long basket_index = 0; basket_index+1 < begins.size(); basket_index++ )
+      {
+         const unsigned long basket_size = begins[basket_index+1]-begins[basket_index];
+         if( basket_size < candidate_size ) continue;
+         kernel_baskets++;
+         kernel_items += basket_size;
+         pair_visits += basket_size*(basket_size-1)/2;
+         trie->find_candidate( items.data()+begins[basket_index], items.data()+begins[basket_index+1], candidate_size );
+      }
+      if( (!only_level || only_level == candidate_size) && kernel_baskets )
+      {
+         vector<unsigned long> saved_counters;
+         vector<COUNTER>       counters( candidate_size > 2 ? trie->counter_number() : 0 );
+         vector<double>        times;
+         unsigned long         visits = pair_visits,
+                               cache_misses = 0;
+         trie->get_counters( saved_counters );
+         for( unsigned long repeat_index = 0; repeat_index < repeat; repeat_index++ )
+         {
+            Counting_context<COUNTER> context = trie->counting_context( false, counters.data() );
+            misses.start();
+            const double begin_time = Metrics::wall_time();
+            for( unsigned long basket_index = 0; basket_index+1 < begins.size(); basket_index++ )
+            {
+               if( begins[basket_index+1]-begins[basket_index] < candidate_size ) continue;
+               if( candidate_size == 2 )
+                  trie->find_candidate( items.data()+begins[basket_index], items.data()+begins[basket_index+1], candidate_size );
+               else
+                  trie->find_candidate( items.data()+begins[basket_index], items.data()+begins[basket_index+1], candidate_size, 1, context );
+            }
+            times.push_back( Metrics::wall_time()-begin_time );
+            cache_misses += misses.stop();
+            if( candidate_size > 2 )
+            {
+               visits = 0;
+               for( unsigned long depth = 0; depth < context.visits.size(); depth++ ) visits += context.visits[depth];
+            }
+         }
+         trie->set_counters( saved_counters, false );
+         sort( times.begin(), times.end() );
+         cout << setw( 5 ) << (unsigned long) candidate_size << setw( 12 ) << candidate_number << setw( 10 ) << kernel_baskets
+              << setw( 8 ) << setprecision( 2 ) << (double) kernel_items/kernel_baskets
+              << setw( 14 ) << setprecision( 1 ) << times.front()*1e9/kernel_baskets << setw( 14 ) << times[times.size()/2]*1e9/kernel_baskets
+              << setw( 14 ) << setprecision( 2 ) << (double) visits/kernel_baskets;
+         if( misses.available() ) cout << setw( 14 ) << (double) cache_misses/repeat/kernel_baskets << endl;
+         else cout << setw( 14 ) << "n/a" << endl;
+      }
+      trie->delete_infrequent( min_supp_abs );
+      trie_size = trie->node_number();
+      trie->candidate_generation( candidate_size );
+   }
+   if( !misses.available() ) cout << endl << "The cache miss counter is not available (perf_event_open failed)." << endl;
+   delete trie;
+}
+
+void usage()
+{
+   cerr << "\nUsage: bench_counting [options] basketfile min_supp";
+   cerr << "\n\nOptions:";
+   cerr << "\n --hash <num>\n  -t <num>\t    use Trie_hash with the given child threshold (or auto),";
+   cerr << "\n\t\t    as the --hash option of apriori.";
+   cerr << "\n --repeat <num>\n  -r <num>\t    time the kernel of every level num times. Default: 5";
+   cerr << "\n --level <num>\n  -l <num>\t    time only the kernel of the candidates of size num.\n\n";
+}
+
+int main( int argc, char *argv[] )
+{
+   int           trie_type = 1, child_threshold = 30, optch, cmdindex = 0;
+   unsigned long repeat = 5, only_level = 0;
+   char          stropts[] = "ht:r:l:";
+   struct option lopts[] =
+   {
+      {"help",0,0,'h'},
+      {"hash",1,0,'t'},
+      {"repeat",1,0,'r'},
+      {"level",1,0,'l'},
+      {0,0,0,0}
+   };
+   while( (optch = getopt_long( argc, argv, stropts, lopts, &cmdindex )) != EOF )
+      switch( optch )
+      {
+         case 't' : trie_type = 2;
+                 if( !strcmp( optarg, "auto" ) ) {child_threshold = 0; break;}
+                 child_threshold = atoi( optarg );
+                 if( child_threshold < 1 ) child_threshold = 30;
+                 break;
+         case 'r' : repeat = strtoul( optarg, 0, 10 );
+                 if( !repeat ) repeat = 1;
+                 break;
+         case 'l' : only_level = strtoul( optarg, 0, 10 );
+                 break;
+         default:   usage(); exit(1);
+      }
+   if( argc != optind+2 ) {usage(); exit(1);}
+   const double min_supp = atof( argv[optind+1] );
+   if( min_supp <= 0 || min_supp > 1 ) {cerr << "\nmin_supp should be in the interval (0,1]." << endl; exit(1);}
+
+   Input_data input;
+   if( !input.open( argv[optind] ) ) {cerr << "\nThe basket file cannot be read!" << endl; exit(1);}
+   Baskets               baskets;
+   vector<itemtype>      basket;
+   vector<unsigned long> item_counters;
+   unsigned long         basket_number = 0;
+   baskets.begins.push_back( 0 );
+   while( input.read_in_a_line( basket ) )
+   {
+      if( basket.empty() ) continue;
+      basket_number++;
+      for( vector<itemtype>::const_iterator it_basket = basket.begin(); it_basket != basket.end(); it_basket++ )
+      {
+         if( *it_basket+1 >= item_counters.size() ) item_counters.resize( *it_basket+2, 0 );
+         item_counters[*it_basket+1]++;
+      }
+      baskets.items.insert( baskets.items.end(), basket.begin(), basket.end() );
+      baskets.begins.push_back( baskets.items.size() );
+   }
+   input.close();
+   const unsigned long min_supp_abs = (unsigned long) ceil( min_supp*basket_number );
+   unsigned long       item_number = 0;
+   for( unsigned long item_index = 1; item_index < item_counters.size(); item_index++ )
+      if( item_counters[item_index] >= min_supp_abs ) item_number++;
+
+   // the same instantiations as Apriori_driver chooses
+   if( item_number < numeric_limits<unsigned short>::max() )
+   {
+      if( basket_number <= numeric_limits<unsigned int>::max() )
+         benchmark<unsigned short, unsigned int, unsigned int>( baskets, item_counters, basket_number, min_supp_abs, trie_type,
+                                                                child_threshold, repeat, only_level );
+      else benchmark<unsigned short, unsigned int, unsigned long>( baskets, item_counters, basket_number, min_supp_abs, trie_type,
+                                                                   child_threshold, repeat, only_level );
+   }
+   else
+   {
+      if( basket_number <= numeric_limits<unsigned int>::max() )
+         benchmark<unsigned int, unsigned int, unsigned int>( baskets, item_counters, basket_number, min_supp_abs, trie_type,
+                                                              child_threshold, repeat, only_level );
+      else benchmark<unsigned int, unsigned int, unsigned long>( baskets, item_counters, basket_number, min_supp_abs, trie_type,
+                                                                 child_threshold, repeat, only_level );
+   }
+   return 0;
+}